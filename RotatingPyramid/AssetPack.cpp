@@ -0,0 +1,296 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t   MIN_MATCH   = 4;
+constexpr size_t   MAX_OFFSET  = 65535;
+constexpr uint32_t HASH_BITS   = 14;
+
+inline uint32_t Read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint32_t Hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// 15 in the token nibble means more length bytes follow, each adding up to 255
+void PutLength(std::vector<uint8_t>& out, size_t length) {
+    for (; length >= 255; length -= 255) {
+        out.push_back(255);
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+void PutSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    const size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+
+    out.push_back(static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+
+    if (literalCount >= 15) {
+        PutLength(out, literalCount - 15);
+    }
+
+    out.insert(out.end(), literals, literals + literalCount);
+
+    // the last sequence carries literals only
+    if (matchLength == 0) {
+        return;
+    }
+
+    out.push_back(static_cast<uint8_t>(offset));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+
+    if (matchCode >= 15) {
+        PutLength(out, matchCode - 15);
+    }
+}
+
+size_t GetLength(const uint8_t*& src, const uint8_t* srcEnd, size_t length) {
+    if (length != 15) {
+        return length;
+    }
+
+    for (;;) {
+        if (src >= srcEnd) {
+            throw std::runtime_error("Corrupt compressed asset!");
+        }
+
+        uint8_t b = *src++;
+        length += b;
+
+        if (b != 255) {
+            return length;
+        }
+    }
+}
+
+}
+
+void AssetPack::Open(const std::string& path) {
+    file.Open(path);
+
+    const uint8_t* data = file.Data();
+    const size_t   size = file.Size();
+
+    if (size < sizeof(AssetPackHeader)) {
+        throw std::runtime_error("Not an asset pack: " + path);
+    }
+
+    AssetPackHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        throw std::runtime_error("Not an asset pack or wrong version: " + path);
+    }
+
+    if (size < sizeof(AssetPackHeader) + size_t(header.entryCount) * sizeof(AssetPackEntry)) {
+        throw std::runtime_error("Asset pack " + path + " is truncated");
+    }
+
+    entries    = reinterpret_cast<const AssetPackEntry*>(data + sizeof(AssetPackHeader));
+    entryCount = header.entryCount;
+
+    for (const AssetPackEntry& entry : *this) {
+        if (entry.name[sizeof(entry.name) - 1] != '\0' || entry.offset > size || entry.storedSize > size - entry.offset
+            || (entry.compression == AssetCompression::None && entry.storedSize != entry.size)) {
+            throw std::runtime_error("Asset pack " + path + " has a bad entry");
+        }
+    }
+}
+
+const AssetPackEntry* AssetPack::Find(const std::string& path) const {
+    const std::string name = NormalizeName(path);
+
+    auto it = std::lower_bound(begin(), end(), name, [](const AssetPackEntry& entry, const std::string& n) {
+        return std::strcmp(entry.name, n.c_str()) < 0;
+    });
+
+    return (it != end() && name == it->name) ? it : nullptr;
+}
+
+std::string AssetPack::NormalizeName(std::string name) {
+    for (char& c : name) {
+        c = (c == '\\') ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    return name;
+}
+
+const uint8_t* AssetPack::Data(const AssetPackEntry& entry) const {
+    return (entry.compression == AssetCompression::None) ? file.Data() + entry.offset : nullptr;
+}
+
+void AssetPack::Read(const AssetPackEntry& entry, uint8_t* dst) const {
+    const uint8_t* src = file.Data() + entry.offset;
+
+    switch (entry.compression) {
+    case AssetCompression::None:
+        std::memcpy(dst, src, entry.size);
+        break;
+    case AssetCompression::Lz:
+        Decompress(src, entry.storedSize, dst, entry.size);
+        break;
+    default:
+        throw std::runtime_error(std::string("Unknown compression for asset ") + entry.name);
+    }
+}
+
+void AssetPack::Write(const std::string& path, std::vector<Source> sources) {
+    std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.name < b.name; });
+
+    std::vector<AssetPackEntry>       toc(sources.size());
+    std::vector<std::vector<uint8_t>> payloads(sources.size());
+
+    uint64_t offset = sizeof(AssetPackHeader) + toc.size() * sizeof(AssetPackEntry);
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        Source&         source = sources[i];
+        AssetPackEntry& entry  = toc[i];
+
+        if (source.name.size() >= sizeof(entry.name)) {
+            throw std::runtime_error("Asset name too long: " + source.name);
+        }
+
+        if (i > 0 && source.name == sources[i - 1].name) {
+            throw std::runtime_error("Duplicate asset: " + source.name);
+        }
+
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, source.name.c_str(), source.name.size());
+
+        entry.type = source.type;
+        entry.size = source.data.size();
+
+        std::vector<uint8_t> compressed = Compress(source.data.data(), source.data.size());
+
+        if (compressed.size() < source.data.size() - source.data.size() / 8) {
+            entry.compression = AssetCompression::Lz;
+            payloads[i]       = std::move(compressed);
+        }
+        else {
+            entry.compression = AssetCompression::None;
+            payloads[i]       = std::move(source.data);
+        }
+
+        offset           = (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        entry.offset     = offset;
+        entry.storedSize = payloads[i].size();
+        offset          += entry.storedSize;
+    }
+
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+
+    AssetPackHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version    = VERSION;
+    header.entryCount = static_cast<uint32_t>(toc.size());
+    header.alignment  = ALIGNMENT;
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(AssetPackEntry));
+
+    uint64_t written = sizeof(AssetPackHeader) + toc.size() * sizeof(AssetPackEntry);
+    std::vector<char> padding(ALIGNMENT, 0);
+
+    for (size_t i = 0; i < toc.size(); ++i) {
+        out.write(padding.data(), toc[i].offset - written);
+        out.write(reinterpret_cast<const char*>(payloads[i].data()), payloads[i].size());
+
+        written = toc[i].offset + toc[i].storedSize;
+    }
+
+    if (!out) {
+        throw std::runtime_error("Could not write " + path);
+    }
+}
+
+std::vector<uint8_t> AssetPack::Compress(const uint8_t* data, size_t size) {
+    std::vector<uint8_t> out;
+    out.reserve(size / 2 + 16);
+
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, UINT32_MAX);
+
+    size_t anchor = 0;
+    size_t i      = 0;
+
+    while (i + MIN_MATCH <= size) {
+        const uint32_t h         = Hash(Read32(data + i));
+        const uint32_t candidate = table[h];
+
+        table[h] = static_cast<uint32_t>(i);
+
+        if (candidate == UINT32_MAX || i - candidate > MAX_OFFSET || Read32(data + candidate) != Read32(data + i)) {
+            i++;
+            continue;
+        }
+
+        size_t length = MIN_MATCH;
+        while (i + length < size && data[candidate + length] == data[i + length]) {
+            length++;
+        }
+
+        PutSequence(out, data + anchor, i - anchor, i - candidate, length);
+
+        i     += length;
+        anchor = i;
+    }
+
+    PutSequence(out, data + anchor, size - anchor, 0, 0);
+
+    return out;
+}
+
+void AssetPack::Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    const uint8_t* srcEnd = src + srcSize;
+    size_t         pos    = 0;
+
+    while (src < srcEnd) {
+        const uint8_t token = *src++;
+
+        size_t literals = GetLength(src, srcEnd, token >> 4);
+        if (literals > size_t(srcEnd - src) || literals > dstSize - pos) {
+            throw std::runtime_error("Corrupt compressed asset!");
+        }
+
+        std::memcpy(dst + pos, src, literals);
+        src += literals;
+        pos += literals;
+
+        if (src == srcEnd) {
+            break;
+        }
+
+        if (srcEnd - src < 2) {
+            throw std::runtime_error("Corrupt compressed asset!");
+        }
+
+        const size_t offset = src[0] | (size_t(src[1]) << 8);
+        src += 2;
+
+        const size_t length = GetLength(src, srcEnd, token & 15) + MIN_MATCH;
+        if (offset == 0 || offset > pos || length > dstSize - pos) {
+            throw std::runtime_error("Corrupt compressed asset!");
+        }
+
+        // byte by byte, matches may overlap what they produce
+        for (size_t k = 0; k < length; ++k, ++pos) {
+            dst[pos] = dst[pos - offset];
+        }
+    }
+
+    if (pos != dstSize) {
+        throw std::runtime_error("Corrupt compressed asset!");
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Asset pack: a 16 byte header, a name sorted table of contents, then every payload on its
+// own 64 KiB boundary. Payloads are stored the way the GPU consumes them (SPIR-V words,
+// KTX2 textures with their whole mip chain), optionally LZ compressed. The runtime maps the
+// file and either hands out pointers into the mapping or decompresses into the caller's
+// memory, usually a mapped staging buffer. Little endian only.
+
+enum class AssetType : uint32_t {
+    Raw     = 0,
+    Spirv   = 1,
+    Texture = 2,        // KTX2 container
+};
+
+enum class AssetCompression : uint32_t {
+    None    = 0,
+    Lz      = 1,        // byte oriented LZ77, LZ4 style sequences
+};
+
+struct AssetPackHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t alignment;
+};
+
+struct AssetPackEntry {
+    char             name[96];      // lowercase relative path with '/' separators, zero terminated
+    AssetType        type;
+    AssetCompression compression;
+    uint64_t         offset;        // from the start of the file
+    uint64_t         storedSize;
+    uint64_t         size;          // after decompression
+};
+
+static_assert(sizeof(AssetPackHeader) == 16, "AssetPackHeader layout");
+static_assert(sizeof(AssetPackEntry) == 128, "AssetPackEntry layout");
+
+class AssetPack {
+public:
+    static constexpr char     MAGIC[4]  = { 'H', 'P', 'A', 'K' };
+    static constexpr uint32_t VERSION   = 1;
+    static constexpr uint32_t ALIGNMENT = 64 * 1024;
+
+    void Open(const std::string& path);
+    bool IsOpen() const { return file.IsOpen(); }
+
+    // names match without regard to case or slash direction, like the Windows paths they stand for
+    const AssetPackEntry* Find(const std::string& name) const;
+    static std::string    NormalizeName(std::string name);
+
+    const AssetPackEntry* begin() const { return entries; }
+    const AssetPackEntry* end() const { return entries + entryCount; }
+
+    // the payload in place, null when it is compressed
+    const uint8_t* Data(const AssetPackEntry& entry) const;
+
+    // entry.size bytes into dst, copied or decompressed
+    void Read(const AssetPackEntry& entry, uint8_t* dst) const;
+
+    // PackTool side
+    struct Source {
+        std::string          name;
+        AssetType            type;
+        std::vector<uint8_t> data;
+    };
+
+    // sources are compressed when that saves at least an eighth
+    static void Write(const std::string& path, std::vector<Source> sources);
+
+    static std::vector<uint8_t> Compress(const uint8_t* data, size_t size);
+    static void                 Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+private:
+    MappedFile            file;
+    const AssetPackEntry* entries    = nullptr;
+    uint32_t              entryCount = 0;
+};
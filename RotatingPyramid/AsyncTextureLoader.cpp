@@ -0,0 +1,165 @@
+#include "AsyncTextureLoader.h"
+
+#include "MipGenerator.h"
+
+#include <stb_image.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const VkFormatFeatureFlags SAMPLE_FEATURES = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+const VkFormatFeatureFlags BLIT_FEATURES   = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+void DecodeKtx2(DecodedTexture& texture, KtxLoader::Texture ktx, const AsyncTextureLoader::FormatQuery& query) {
+    texture.width     = ktx.width;
+    texture.height    = ktx.height;
+    texture.mipLevels = static_cast<uint32_t>(ktx.levels.size());
+
+    // the file's own format if the device samples it, else the RGBA8 a CPU decode lands in
+    if (query(ktx.format, SAMPLE_FEATURES)) {
+        texture.format = ktx.format;
+
+        for (const KtxLoader::Level& level : ktx.levels) {
+            texture.levels.push_back({ level.width, level.height, size_t(level.offset), size_t(level.size) });
+        }
+
+        texture.container = std::move(ktx);
+        return;
+    }
+
+    texture.format = KtxLoader::DecodedFormat(ktx.format);
+    if (texture.format == VK_FORMAT_UNDEFINED || !query(texture.format, SAMPLE_FEATURES)) {
+        throw std::runtime_error("No sampleable format for " + texture.path);
+    }
+
+    size_t total = 0;
+    for (const KtxLoader::Level& level : ktx.levels) {
+        texture.levels.push_back({ level.width, level.height, total, size_t(level.width) * level.height * 4 });
+        total += texture.levels.back().size;
+    }
+
+    texture.pixels.resize(total);
+
+    for (size_t i = 0; i < ktx.levels.size(); ++i) {
+        const DecodedTexture::Level& level = texture.levels[i];
+        KtxLoader::Decode(ktx.format, ktx.LevelData(i), level.width, level.height, texture.pixels.data() + level.offset);
+    }
+}
+
+// packed textures are always KTX2, PackTool converts everything else
+void DecodePacked(DecodedTexture& texture, const AssetPack& pack, const AssetPackEntry& entry, const AsyncTextureLoader::FormatQuery& query) {
+    if (entry.type != AssetType::Texture) {
+        throw std::runtime_error("Asset " + texture.path + " is not a texture");
+    }
+
+    if (const uint8_t* data = pack.Data(entry)) {
+        DecodeKtx2(texture, KtxLoader::Parse(data, entry.size, texture.path), query);
+        return;
+    }
+
+    std::vector<uint8_t> storage(entry.size);
+    pack.Read(entry, storage.data());
+
+    KtxLoader::Texture ktx = KtxLoader::Parse(storage.data(), storage.size(), texture.path);
+    ktx.storage = std::move(storage);
+
+    DecodeKtx2(texture, std::move(ktx), query);
+}
+
+void DecodeImage(DecodedTexture& texture, const AsyncTextureLoader::FormatQuery& query, bool cpuMips) {
+    int width, height, channels;
+
+    stbi_uc* pPixels = stbi_load(texture.path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pPixels) {
+        throw std::runtime_error("Could not load texture " + texture.path);
+    }
+
+    texture.format    = VK_FORMAT_R8G8B8A8_SRGB;
+    texture.width     = width;
+    texture.height    = height;
+    texture.mipLevels = MipGenerator::MipLevelCount(width, height);
+
+    // blitting the chain needs linear filtering on the format, else it is built here
+    if (!cpuMips && query(texture.format, BLIT_FEATURES)) {
+        const size_t size = size_t(width) * height * 4;
+
+        texture.levels.push_back({ texture.width, texture.height, 0, size });
+        texture.pixels.assign(pPixels, pPixels + size);
+    }
+    else {
+        for (const MipGenerator::Level& level : MipGenerator::Generate(pPixels, width, height, true, texture.pixels)) {
+            texture.levels.push_back({ level.width, level.height, level.offset, size_t(level.width) * level.height * 4 });
+        }
+    }
+
+    stbi_image_free(pPixels);
+}
+
+}
+
+AsyncTextureLoader::AsyncTextureLoader(ThreadPool& pool, FormatQuery query, bool cpuMips, const AssetPack* pack)
+    : pool(pool)
+    , query(std::move(query))
+    , cpuMips(cpuMips)
+    , pack(pack) {
+}
+
+void AsyncTextureLoader::Request(const std::string& path) {
+    pending++;
+
+    pool.Submit([completed = completed, query = query, cpuMips = cpuMips, pack = pack, path] {
+        DecodedTexture texture;
+
+        try {
+            texture = Decode(path, query, cpuMips, pack);
+        }
+        catch (const std::exception& err) {
+            texture       = DecodedTexture{};
+            texture.path  = path;
+            texture.error = err.what();
+        }
+
+        std::lock_guard<std::mutex> lock(completed->mutex);
+        completed->textures.push_back(std::move(texture));
+    });
+}
+
+bool AsyncTextureLoader::Poll(DecodedTexture& texture) {
+    std::lock_guard<std::mutex> lock(completed->mutex);
+
+    if (completed->textures.empty()) {
+        return false;
+    }
+
+    texture = std::move(completed->textures.front());
+    completed->textures.pop_front();
+    pending--;
+
+    return true;
+}
+
+DecodedTexture AsyncTextureLoader::Decode(const std::string& path, const FormatQuery& query, bool cpuMips, const AssetPack* pack) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    DecodedTexture texture;
+    texture.path = path;
+
+    const AssetPackEntry* entry = pack ? pack->Find(path) : nullptr;
+
+    if (entry) {
+        DecodePacked(texture, *pack, *entry, query);
+    }
+    else if (KtxLoader::IsKtx2(path)) {
+        DecodeKtx2(texture, KtxLoader::Load(path), query);
+    }
+    else {
+        DecodeImage(texture, query, cpuMips);
+    }
+
+    texture.decodeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    return texture;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "AssetPack.h"
+#include "KtxLoader.h"
+#include "ThreadPool.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// A texture ready for upload: every mip the CPU produced, in the format the image gets.
+// KTX2 levels the device samples natively stay in their container, which may point into
+// the mapped file or asset pack.
+struct DecodedTexture {
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        size_t   offset;        // bytes into Data()
+        size_t   size;
+    };
+
+    std::string        path;
+    std::string        error;           // set instead of everything below when decoding failed
+
+    VkFormat           format    = VK_FORMAT_UNDEFINED;
+    uint32_t           width     = 0;
+    uint32_t           height    = 0;
+    uint32_t           mipLevels = 1;   // of the image; above levels.size() the rest is blitted
+    std::vector<Level> levels;
+    float              decodeMs  = 0.0f;
+
+    std::vector<uint8_t> pixels;
+    KtxLoader::Texture   container;
+
+    const uint8_t* Data() const { return container.data ? container.data : pixels.data(); }
+};
+
+// Decodes PNG and KTX2 files, or textures of an asset pack, on a thread pool. The render
+// thread polls for finished textures once a frame and uploads them, so startup never waits
+// on a decode.
+class AsyncTextureLoader {
+public:
+    // whether an optimal tiling image of the format supports the features, asked from workers
+    using FormatQuery = std::function<bool(VkFormat format, VkFormatFeatureFlags features)>;
+
+    // paths found in the pack (if any) are read from it, everything else from disk
+    AsyncTextureLoader(ThreadPool& pool, FormatQuery query, bool cpuMips, const AssetPack* pack = nullptr);
+
+    void   Request(const std::string& path);
+
+    // next finished texture, in completion order; false when none is ready
+    bool   Poll(DecodedTexture& texture);
+
+    size_t Pending() const { return pending; }
+
+    // the work one request does, on the calling thread; throws on failure
+    static DecodedTexture Decode(const std::string& path, const FormatQuery& query, bool cpuMips, const AssetPack* pack = nullptr);
+
+private:
+    struct Completed {
+        std::mutex                 mutex;
+        std::deque<DecodedTexture> textures;
+    };
+
+    ThreadPool&                pool;
+    FormatQuery                query;
+    bool                       cpuMips;
+    const AssetPack*           pack;
+    size_t                     pending = 0;
+
+    // shared with the jobs, which may outlive the loader until the pool joins
+    std::shared_ptr<Completed> completed = std::make_shared<Completed>();
+};
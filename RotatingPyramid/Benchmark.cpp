@@ -0,0 +1,115 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+
+// nearest rank
+float Percentile(const std::vector<float>& sorted, uint32_t percent) {
+    const size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+}
+
+FrameTimes::Summary FrameTimes::Summarize() const {
+    if (samples.empty()) {
+        return {};
+    }
+
+    std::vector<float> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (float ms : sorted) {
+        sum += ms;
+    }
+
+    return Summary {
+        static_cast<uint32_t>(sorted.size()),
+        static_cast<float>(sum / sorted.size()),
+        Percentile(sorted, 50),
+        Percentile(sorted, 95),
+        Percentile(sorted, 99),
+        sorted.back()
+    };
+}
+
+Benchmark::Benchmark(uint32_t warmupFrames, uint32_t measuredFrames, float timestepMs)
+    : warmupFrames(warmupFrames)
+    , measuredFrames(measuredFrames)
+    , timestepMs(timestepMs) {
+}
+
+uint64_t Benchmark::EndFrame(float cpuMs) {
+    if (IsMeasured(frame)) {
+        cpu.Add(cpuMs);
+    }
+
+    return frame++;
+}
+
+void Benchmark::AddGpuFrame(uint64_t f, float gpuMs) {
+    if (IsMeasured(f) && gpuMs > 0.0f) {
+        gpu.Add(gpuMs);
+    }
+}
+
+void Benchmark::Print(std::ostream& out) const {
+    auto line = [&](const char* name, const FrameTimes::Summary& s) {
+        out << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(8) << s.count << std::setw(9) << s.avg << std::setw(9) << s.p50
+            << std::setw(9) << s.p95 << std::setw(9) << s.p99 << std::setw(9) << s.max << '\n';
+    };
+
+    out << "Benchmark: " << warmupFrames << " warmup, " << measuredFrames << " measured frames, "
+        << timestepMs << " ms timestep\n";
+
+    out << std::left << std::setw(8) << "ms" << std::right << std::setw(8) << "frames" << std::setw(9) << "avg"
+        << std::setw(9) << "p50" << std::setw(9) << "p95" << std::setw(9) << "p99" << std::setw(9) << "max" << '\n';
+
+    line("CPU", cpu.Summarize());
+    line("GPU", gpu.Summarize());
+
+    out << std::defaultfloat << std::flush;
+}
+
+void Benchmark::Write(const std::string& path) const {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Could not open " + path);
+    }
+
+    const FrameTimes::Summary summaries[] = { cpu.Summarize(), gpu.Summarize() };
+    const char*               names[]     = { "cpu", "gpu" };
+
+    file << std::fixed << std::setprecision(4);
+
+    const bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+
+    if (csv) {
+        file << "timer,frames,avg_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+
+        for (int i = 0; i < 2; ++i) {
+            const FrameTimes::Summary& s = summaries[i];
+            file << names[i] << ',' << s.count << ',' << s.avg << ',' << s.p50 << ',' << s.p95 << ',' << s.p99 << ',' << s.max << '\n';
+        }
+
+        return;
+    }
+
+    file << "{\n  \"warmupFrames\": " << warmupFrames << ",\n  \"measuredFrames\": " << measuredFrames
+         << ",\n  \"timestepMs\": " << timestepMs;
+
+    for (int i = 0; i < 2; ++i) {
+        const FrameTimes::Summary& s = summaries[i];
+        file << ",\n  \"" << names[i] << "\": { \"frames\": " << s.count << ", \"avgMs\": " << s.avg
+             << ", \"p50Ms\": " << s.p50 << ", \"p95Ms\": " << s.p95 << ", \"p99Ms\": " << s.p99
+             << ", \"maxMs\": " << s.max << " }";
+    }
+
+    file << "\n}\n";
+}
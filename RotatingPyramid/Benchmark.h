@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Every sample of one measurement, for percentiles over a whole run.
+class FrameTimes {
+public:
+    struct Summary {
+        uint32_t count;
+        float    avg;
+        float    p50;
+        float    p95;
+        float    p99;
+        float    max;
+    };
+
+    void    Add(float ms) { samples.push_back(ms); }
+    Summary Summarize() const;
+
+private:
+    std::vector<float> samples;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// A fixed run: warmup frames that are rendered but not measured, then measured frames, then
+// the end. The animation advances a fixed timestep per frame instead of following the clock,
+// so every run renders the same frames. GPU times arrive a few frames late, from the
+// profiler; they are counted for the frames whose CPU time was.
+class Benchmark {
+public:
+    Benchmark(uint32_t warmupFrames, uint32_t measuredFrames, float timestepMs);
+
+    // animation time of the frame being recorded
+    float Time() const { return float(frame) * timestepMs * 1e-3f; }
+
+    // cpuMs: the frame's CPU work, waits on the GPU and swapchain left out
+    uint64_t EndFrame(float cpuMs);
+
+    // frame is the one the GPU time belongs to, as returned by EndFrame
+    void     AddGpuFrame(uint64_t frame, float gpuMs);
+
+    // every measured frame rendered; GPU times of the last few may still be outstanding
+    bool Done() const { return frame >= warmupFrames + measuredFrames; }
+
+    void Print(std::ostream& out) const;
+
+    // .csv for one row per measurement, anything else is written as JSON
+    void Write(const std::string& path) const;
+
+private:
+    bool IsMeasured(uint64_t f) const { return f >= warmupFrames && f < warmupFrames + measuredFrames; }
+
+    uint32_t   warmupFrames;
+    uint32_t   measuredFrames;
+    float      timestepMs;
+
+    uint64_t   frame = 0;
+    FrameTimes cpu;
+    FrameTimes gpu;
+};
@@ -0,0 +1,141 @@
+// Percentiles and result files of the benchmark mode, without a window or a device:
+//
+//     BenchmarkTests
+//
+// Run by CTest; result files are written to the working directory.
+
+#include "Benchmark.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void Check(bool ok, const char* what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+bool Near(float a, float b) {
+    return std::fabs(a - b) < 1e-4f;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+bool Contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+void TestEmpty() {
+    const FrameTimes::Summary s = FrameTimes().Summarize();
+
+    Check(s.count == 0 && s.avg == 0.0f && s.max == 0.0f, "empty summary is all zero");
+}
+
+void TestPercentiles() {
+    FrameTimes times;
+
+    // out of order, the summary sorts
+    for (int i = 100; i >= 1; --i) {
+        times.Add(float(i));
+    }
+
+    const FrameTimes::Summary s = times.Summarize();
+
+    Check(s.count == 100,       "count");
+    Check(Near(s.avg, 50.5f),   "average");
+    Check(Near(s.p50, 50.0f),   "p50 is the nearest rank");
+    Check(Near(s.p95, 95.0f),   "p95 is the nearest rank");
+    Check(Near(s.p99, 99.0f),   "p99 is the nearest rank");
+    Check(Near(s.max, 100.0f),  "max");
+}
+
+void TestSingleSample() {
+    FrameTimes times;
+    times.Add(7.0f);
+
+    const FrameTimes::Summary s = times.Summarize();
+
+    Check(s.count == 1 && Near(s.p50, 7.0f) && Near(s.p99, 7.0f) && Near(s.max, 7.0f), "one sample is every percentile");
+}
+
+// 2 warmup and 3 measured frames; CPU times 1..6 ms, GPU times 10 times that, arriving late
+Benchmark RunBenchmark() {
+    Benchmark benchmark(2, 3, 10.0f);
+
+    Check(Near(benchmark.Time(), 0.0f), "animation starts at 0");
+
+    for (int i = 1; !benchmark.Done(); ++i) {
+        const uint64_t frame = benchmark.EndFrame(float(i));
+
+        if (frame > 0) {
+            benchmark.AddGpuFrame(frame - 1, float(frame) * 10.0f);
+        }
+    }
+
+    Check(Near(benchmark.Time(), 0.05f), "fixed timestep");
+
+    // the last measured frame's GPU time, then one that never ran on the GPU
+    benchmark.AddGpuFrame(4, 50.0f);
+    benchmark.AddGpuFrame(5, 0.0f);
+    return benchmark;
+}
+
+void TestWriteCsv() {
+    const std::string path = "benchmark_test.csv";
+
+    RunBenchmark().Write(path);
+    const std::string text = ReadFile(path);
+
+    Check(Contains(text, "timer,frames,avg_ms,p50_ms,p95_ms,p99_ms,max_ms\n"), "csv header");
+    Check(Contains(text, "cpu,3,4.0000,4.0000,5.0000,5.0000,5.0000\n"),        "csv cpu row, warmup left out");
+    Check(Contains(text, "gpu,3,40.0000,40.0000,50.0000,50.0000,50.0000\n"),   "csv gpu row, late times counted");
+
+    std::remove(path.c_str());
+}
+
+void TestWriteJson() {
+    const std::string path = "benchmark_test.json";
+
+    RunBenchmark().Write(path);
+    const std::string text = ReadFile(path);
+
+    Check(Contains(text, "\"warmupFrames\": 2"),   "json warmup frames");
+    Check(Contains(text, "\"measuredFrames\": 3"), "json measured frames");
+    Check(Contains(text, "\"cpu\": { \"frames\": 3, \"avgMs\": 4.0000, \"p50Ms\": 4.0000"), "json cpu summary");
+    Check(Contains(text, "\"gpu\": { \"frames\": 3, \"avgMs\": 40.0000"),                   "json gpu summary");
+    Check(text.front() == '{' && Contains(text, "}\n}\n"),                                  "json closed");
+
+    std::remove(path.c_str());
+}
+
+}
+
+int main() {
+    TestEmpty();
+    TestPercentiles();
+    TestSingleSample();
+    TestWriteCsv();
+    TestWriteJson();
+
+    if (failures) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Benchmark tests passed" << std::endl;
+    return 0;
+}
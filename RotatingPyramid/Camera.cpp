@@ -0,0 +1,43 @@
+#include "Camera.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+glm::mat4 Camera::View() {
+    return glm::lookAt(
+        glm::vec3(0.0f, 0.25f, -1.0f), // eye position 
+        glm::vec3(0.0f, 0.0f, 0.0f),  // looking at 
+        glm::vec3(0.0f, 1.0f, 0.0f)   // up vector
+    );
+}
+
+glm::mat4 Camera::Projection(float aspect) {
+    return glm::perspective(
+        glm::radians(70.0f),         // fov
+        aspect,                      // aspect ratio
+        0.1f,                       // near 
+        20.0f                       // far
+    );
+}
+
+const glm::mat4& Camera::Clip() {
+    // https://github.com/LunarG/VulkanSamples/blob/master/Sample-Programs/Hologram/Hologram.cpp
+    static const glm::mat4 clip = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0, -1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.5f, 0.5f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    return clip;
+}
+
+void Camera::FrustumPlanes(const glm::mat4& m, glm::vec4 planes[6]) {
+    auto row = [&](int r) { return glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]); };
+
+    planes[0] = row(3) + row(0);  // left
+    planes[1] = row(3) - row(0);  // right
+    planes[2] = row(3) + row(1);  // top / bottom
+    planes[3] = row(3) - row(1);
+    planes[4] = row(2);           // near, z >= 0
+    planes[5] = row(3) - row(2);  // far
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// The fixed camera the scene is viewed from, and the per frame matrix math built on it.
+class Camera {
+public:
+    static glm::mat4 View();
+
+    // GL conventions; [1][1] is cot(fov / 2)
+    static glm::mat4 Projection(float aspect);
+
+    // takes GL clip space to Vulkan's: inverted Y and half Z
+    static const glm::mat4& Clip();
+
+    // inward facing planes of a Vulkan clip space matrix, in the space it takes points from:
+    // left, right, top, bottom, near, far
+    static void FrustumPlanes(const glm::mat4& clipFromSpace, glm::vec4 planes[6]);
+};
@@ -0,0 +1,198 @@
+#include "CpuProfiler.h"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+static_assert((CpuProfiler::RING_SIZE & (CpuProfiler::RING_SIZE - 1)) == 0, "RING_SIZE must be a power of two");
+
+// fields are atomic so the collector may read a slot the owner is overwriting; it finds
+// out from the head afterwards and drops the slot
+struct ZoneSlot {
+    std::atomic<const char*> name  { nullptr };
+    std::atomic<uint64_t>    begin { 0 };
+    std::atomic<uint64_t>    end   { 0 };
+};
+
+struct ThreadRing {
+    uint32_t                 threadId = 0;
+    std::atomic<const char*> threadName { nullptr };
+
+    std::atomic<uint64_t>    head { 0 };        // zones ever written, owner thread only
+    uint64_t                 tail = 0;          // zones collected, under the registry lock
+
+    ZoneSlot                 zones[CpuProfiler::RING_SIZE];
+};
+
+struct Zone {
+    const char* name;
+    uint64_t    begin;
+    uint64_t    end;
+    uint32_t    threadId;
+};
+
+struct Registry {
+    std::mutex                               mutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;     // outlive their threads, for the trace
+    std::deque<Zone>                         timeline;
+    uint64_t                                 lostZones = 0;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+// the tick rate is measured between here and the moment the trace is written
+struct ClockPoint {
+    uint64_t                              ticks;
+    std::chrono::steady_clock::time_point time;
+};
+
+const ClockPoint START = { CpuProfiler::Now(), std::chrono::steady_clock::now() };
+
+thread_local ThreadRing* localRing = nullptr;
+
+ThreadRing& LocalRing() {
+    if (!localRing) {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        registry.rings.push_back(std::make_unique<ThreadRing>());
+
+        localRing           = registry.rings.back().get();
+        localRing->threadId = static_cast<uint32_t>(registry.rings.size());
+    }
+
+    return *localRing;
+}
+
+void WriteEscaped(std::ostream& out, const char* text) {
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') {
+            out << '\\';
+        }
+        out << *text;
+    }
+}
+
+}
+
+void CpuProfiler::SetThreadName(const char* name) {
+    LocalRing().threadName.store(name, std::memory_order_relaxed);
+}
+
+void CpuProfiler::Record(const char* name, uint64_t begin, uint64_t end) {
+    ThreadRing& ring = LocalRing();
+
+    const uint64_t index = ring.head.load(std::memory_order_relaxed);
+    ZoneSlot&      slot  = ring.zones[index & (RING_SIZE - 1)];
+
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::Collect(size_t maxZones) {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    std::vector<Zone> zones;
+
+    for (const std::unique_ptr<ThreadRing>& ring : registry.rings) {
+        const uint64_t head  = ring->head.load(std::memory_order_acquire);
+        uint64_t       first = std::max(ring->tail, head >= RING_SIZE ? head - RING_SIZE : 0);
+
+        zones.clear();
+
+        for (uint64_t i = first; i < head; ++i) {
+            const ZoneSlot& slot = ring->zones[i & (RING_SIZE - 1)];
+
+            zones.push_back({ slot.name.load(std::memory_order_relaxed),
+                              slot.begin.load(std::memory_order_relaxed),
+                              slot.end.load(std::memory_order_relaxed),
+                              ring->threadId });
+        }
+
+        // whatever the owner may have started overwriting meanwhile is dropped
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t newHead = ring->head.load(std::memory_order_relaxed);
+        const uint64_t valid   = newHead >= RING_SIZE ? newHead - RING_SIZE + 1 : 0;
+
+        const size_t   skip    = static_cast<size_t>(std::min<uint64_t>(valid > first ? valid - first : 0, zones.size()));
+
+        registry.lostZones += (first - ring->tail) + skip;
+        registry.timeline.insert(registry.timeline.end(), zones.begin() + skip, zones.end());
+
+        ring->tail = head;
+    }
+
+    if (registry.timeline.size() > maxZones) {
+        registry.timeline.erase(registry.timeline.begin(), registry.timeline.end() - maxZones);
+    }
+}
+
+void CpuProfiler::WriteTrace(const std::string& path) {
+    Collect();
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Could not open " + path);
+    }
+
+    const ClockPoint now = { Now(), std::chrono::steady_clock::now() };
+
+    const double elapsedUs  = std::chrono::duration<double, std::micro>(now.time - START.time).count();
+    const double ticksPerUs = elapsedUs > 0.0 ? double(now.ticks - START.ticks) / elapsedUs : 1.0;
+
+    uint64_t origin = now.ticks;
+    for (const Zone& zone : registry.timeline) {
+        origin = std::min(origin, zone.begin);
+    }
+
+    // Chrome trace event format: one track per thread, complete events in microseconds
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}}";
+
+    for (const std::unique_ptr<ThreadRing>& ring : registry.rings) {
+        const char* name = ring->threadName.load(std::memory_order_relaxed);
+
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadId << ",\"args\":{\"name\":\"";
+        if (name) {
+            WriteEscaped(file, name);
+        }
+        else {
+            file << "thread " << ring->threadId;
+        }
+        file << "\"}}";
+    }
+
+    file << std::fixed << std::setprecision(3);
+
+    for (const Zone& zone : registry.timeline) {
+        file << ",\n{\"name\":\"";
+        WriteEscaped(file, zone.name);
+        file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.threadId
+             << ",\"ts\":" << double(zone.begin - origin) / ticksPerUs
+             << ",\"dur\":" << double(zone.end - zone.begin) / ticksPerUs << "}";
+    }
+
+    file << "\n]}\n";
+
+    if (registry.lostZones) {
+        std::cerr << "CPU trace: " << registry.lostZones << " zones were overwritten before they were collected" << std::endl;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HARMONY_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HARMONY_HAS_RDTSC 1
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// CPU zone profiler. Every thread writes the zones it closes into a ring buffer of its own,
+// without locks; Collect drains all rings into one timeline, which WriteTrace saves as
+// Chrome trace JSON (chrome://tracing, Perfetto). Times are TSC ticks where the CPU has
+// one, steady_clock otherwise, and are converted to microseconds only when writing.
+//
+// Zones are placed with the macros below, which compile to nothing unless the build
+// defines HARMONY_CPU_PROFILER (CMake option of the same name). Zone names must outlive
+// the profiler: string literals or __func__.
+class CpuProfiler {
+public:
+#ifdef HARMONY_CPU_PROFILER
+    static constexpr bool COMPILED_IN = true;
+#else
+    static constexpr bool COMPILED_IN = false;
+#endif
+
+    static constexpr uint32_t RING_SIZE = 16 * 1024;       // zones per thread between collects, a power of two
+
+    static uint64_t Now() {
+#ifdef HARMONY_HAS_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // names the calling thread in the trace
+    static void SetThreadName(const char* name);
+
+    static void Record(const char* name, uint64_t begin, uint64_t end);
+
+    // moves every thread's finished zones to the timeline, keeping at most maxZones of the
+    // newest; call regularly (once a frame), rings that wrapped in between lose their oldest
+    static void Collect(size_t maxZones = 1 << 20);
+
+    static void WriteTrace(const std::string& path);
+};
+
+// closes its zone when it goes out of scope
+class CpuZone {
+public:
+    explicit CpuZone(const char* name) : name(name), begin(CpuProfiler::Now()) {}
+    ~CpuZone() { CpuProfiler::Record(name, begin, CpuProfiler::Now()); }
+
+    CpuZone(const CpuZone&) = delete;
+    CpuZone& operator=(const CpuZone&) = delete;
+
+private:
+    const char* name;
+    uint64_t    begin;
+};
+
+#define CPU_ZONE_CONCAT_(a, b) a##b
+#define CPU_ZONE_CONCAT(a, b)  CPU_ZONE_CONCAT_(a, b)
+
+#ifdef HARMONY_CPU_PROFILER
+#define CPU_ZONE(name)          CpuZone CPU_ZONE_CONCAT(cpuZone, __LINE__)(name)
+#define CPU_FUNCTION_ZONE()     CPU_ZONE(__func__)
+#define CPU_THREAD_NAME(name)   CpuProfiler::SetThreadName(name)
+#else
+#define CPU_ZONE(name)          ((void)0)
+#define CPU_FUNCTION_ZONE()     ((void)0)
+#define CPU_THREAD_NAME(name)   ((void)0)
+#endif
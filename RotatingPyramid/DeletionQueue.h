@@ -0,0 +1,30 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <utility>
+
+// Deleters run in reverse order of appends, so whatever was created last goes first.
+class DeletionQueue {
+    using fn = std::function<void()>;
+    using queue = std::deque<fn>;
+
+    queue dq;
+
+public:
+    void Finalize() {
+        // delete in reverse order of appends
+        for (auto it = dq.rbegin(); it != dq.rend(); it++) {
+            (*it)();
+        }
+
+        dq.clear();
+    }
+
+    template<typename Fn>
+    void Append(Fn&& f) {
+        dq.emplace_back(std::forward<Fn>(f));
+    }
+
+    size_t Size() const { return dq.size(); }
+};
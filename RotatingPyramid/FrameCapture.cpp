@@ -0,0 +1,223 @@
+#include "FrameCapture.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+bool IsBgra(VkFormat format) {
+    return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+uint8_t ClampByte(int value) {
+    return static_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+}
+
+FrameCapture::FrameCapture(const std::string& path, uint32_t every, uint32_t fpsNum, uint32_t fpsDen)
+    : every(std::max(every, 1u))
+    , fpsNum(fpsNum)
+    , fpsDen(std::max(fpsDen, 1u)) {
+    const size_t dot = path.find_last_of('.');
+
+    stem      = dot == std::string::npos ? path : path.substr(0, dot);
+    extension = dot == std::string::npos ? std::string() : path.substr(dot);
+
+    std::string ext = extension;
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+
+    if (ext == ".png") {
+        format = Format::Png;
+    }
+    else if (ext == ".rgba") {
+        format = Format::Raw;
+    }
+    else if (ext == ".y4m") {
+        format = Format::Y4m;
+
+        stream = std::fopen(path.c_str(), "wb");
+        if (!stream) {
+            throw std::runtime_error("Could not open " + path);
+        }
+    }
+    else {
+        throw std::runtime_error("Could not capture to " + path + ", expected .png, .rgba or .y4m");
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    if (stream) {
+        std::fclose(stream);
+    }
+}
+
+uint64_t FrameCapture::WrittenCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+uint64_t FrameCapture::SkippedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return skipped;
+}
+
+void FrameCapture::ToRgba(const ReadbackImage& image, std::vector<uint8_t>& rgba) {
+    const size_t size = size_t(image.width) * image.height * 4;
+
+    rgba.resize(size);
+    std::memcpy(rgba.data(), image.pixels, size);
+
+    if (IsBgra(image.format)) {
+        for (size_t i = 0; i < size; i += 4) {
+            std::swap(rgba[i], rgba[i + 2]);
+        }
+    }
+}
+
+void FrameCapture::ToI420(const ReadbackImage& image, std::vector<uint8_t>& yuv) {
+    const uint32_t w      = image.width;
+    const uint32_t h      = image.height;
+    const uint32_t cw     = (w + 1) / 2;
+    const uint32_t ch     = (h + 1) / 2;
+    const size_t   ySize  = size_t(w) * h;
+
+    yuv.resize(ySize + 2 * size_t(cw) * ch);
+
+    uint8_t* yPlane = yuv.data();
+    uint8_t* uPlane = yPlane + ySize;
+    uint8_t* vPlane = uPlane + size_t(cw) * ch;
+
+    const uint32_t r = IsBgra(image.format) ? 2 : 0;
+    const uint32_t b = 2 - r;
+
+    // fixed point, 8 fractional bits
+    for (uint32_t y = 0; y < h; ++y) {
+        const uint8_t* row = image.pixels + size_t(y) * w * 4;
+
+        for (uint32_t x = 0; x < w; ++x) {
+            const uint8_t* p = row + x * 4;
+            yPlane[size_t(y) * w + x] = ClampByte((77 * p[r] + 150 * p[1] + 29 * p[b] + 128) >> 8);
+        }
+    }
+
+    for (uint32_t cy = 0; cy < ch; ++cy) {
+        for (uint32_t cx = 0; cx < cw; ++cx) {
+            int sumR = 0, sumG = 0, sumB = 0, n = 0;
+
+            for (uint32_t y = cy * 2; y < std::min(cy * 2 + 2, h); ++y) {
+                for (uint32_t x = cx * 2; x < std::min(cx * 2 + 2, w); ++x) {
+                    const uint8_t* p = image.pixels + (size_t(y) * w + x) * 4;
+                    sumR += p[r];
+                    sumG += p[1];
+                    sumB += p[b];
+                    n++;
+                }
+            }
+
+            const int avgR = sumR / n;
+            const int avgG = sumG / n;
+            const int avgB = sumB / n;
+
+            uPlane[size_t(cy) * cw + cx] = ClampByte(((-43 * avgR - 85 * avgG + 128 * avgB + 128) >> 8) + 128);
+            vPlane[size_t(cy) * cw + cx] = ClampByte(((128 * avgR - 107 * avgG - 21 * avgB + 128) >> 8) + 128);
+        }
+    }
+}
+
+std::string FrameCapture::FramePath(const ReadbackImage& image) const {
+    char number[32];
+    std::snprintf(number, sizeof(number), "_%06llu", static_cast<unsigned long long>(image.frameNumber));
+
+    std::string path = stem + number;
+
+    if (format == Format::Raw) {
+        path += "_" + std::to_string(image.width) + "x" + std::to_string(image.height);
+    }
+
+    return path + extension;
+}
+
+void FrameCapture::Write(const ReadbackImage& image) {
+    if (format == Format::Y4m) {
+        WriteStream(image);
+        return;
+    }
+
+    std::vector<uint8_t> rgba;
+    ToRgba(image, rgba);
+
+    const std::string path = FramePath(image);
+    bool ok;
+
+    if (format == Format::Png) {
+        ok = stbi_write_png(path.c_str(), int(image.width), int(image.height), 4, rgba.data(), int(image.width * 4)) != 0;
+    }
+    else {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        ok = file.write(reinterpret_cast<const char*>(rgba.data()), std::streamsize(rgba.size())).good();
+    }
+
+    if (!ok) {
+        ReportError("Could not write " + path);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    written++;
+}
+
+void FrameCapture::WriteStream(const ReadbackImage& image) {
+    StreamFrame frame { image.width, image.height, {} };
+    ToI420(image, frame.yuv);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    pendingFrames.emplace(image.sequence, std::move(frame));
+
+    // whoever fills the gap writes everything that has become contiguous
+    for (auto it = pendingFrames.find(nextSequence); it != pendingFrames.end(); it = pendingFrames.find(nextSequence)) {
+        const StreamFrame& next = it->second;
+
+        if (width == 0) {
+            width  = next.width;
+            height = next.height;
+
+            // full range 4:2:0 with JPEG chroma siting, progressive, square pixels
+            std::fprintf(stream, "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, fpsNum, fpsDen);
+        }
+
+        if (next.width == width && next.height == height) {
+            std::fputs("FRAME\n", stream);
+            std::fwrite(next.yuv.data(), 1, next.yuv.size(), stream);
+            written++;
+        }
+        else {
+            skipped++;
+        }
+
+        pendingFrames.erase(it);
+        nextSequence++;
+    }
+
+    if (std::ferror(stream) && !failed) {
+        failed = true;
+        std::cerr << "Could not write the Y4M stream " << stem << extension << std::endl;
+    }
+}
+
+void FrameCapture::ReportError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!failed) {
+        failed = true;
+        std::cerr << message << std::endl;
+    }
+}
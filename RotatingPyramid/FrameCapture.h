@@ -0,0 +1,79 @@
+#pragma once
+
+#include "FrameReadback.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Writes read back frames to disk from the readback workers. The path's extension picks
+// the format:
+//   .png   one PNG per frame, the frame number put before the extension
+//   .rgba  same, raw 8 bit RGBA rows with the size in the name (frame_000042_1280x720.rgba)
+//   .y4m   one YUV 4:2:0 stream; frames are converted in parallel and written in order,
+//          frames of another size than the first are skipped
+class FrameCapture {
+public:
+    enum class Format {
+        Png,
+        Raw,
+        Y4m,
+    };
+
+    // every: capture frames whose number is a multiple of it; fps goes in the Y4M header
+    // as fpsNum / fpsDen
+    FrameCapture(const std::string& path, uint32_t every, uint32_t fpsNum, uint32_t fpsDen);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    bool   Wants(uint64_t frameNumber) const { return frameNumber % every == 0; }
+
+    // on a worker; errors are reported once and the frame is lost
+    void   Write(const ReadbackImage& image);
+
+    Format GetFormat() const { return format; }
+    uint64_t WrittenCount() const;
+    uint64_t SkippedCount() const;
+
+    // the frames' pixels as RGBA, rows tightly packed
+    static void ToRgba(const ReadbackImage& image, std::vector<uint8_t>& rgba);
+
+    // BT.601 full range, chroma averaged over 2x2 pixels
+    static void ToI420(const ReadbackImage& image, std::vector<uint8_t>& yuv);
+
+private:
+    struct StreamFrame {
+        uint32_t             width;
+        uint32_t             height;
+        std::vector<uint8_t> yuv;
+    };
+
+    std::string FramePath(const ReadbackImage& image) const;
+    void        WriteStream(const ReadbackImage& image);
+    void        ReportError(const std::string& message);
+
+    std::string  stem;          // path without the extension
+    std::string  extension;
+    Format       format;
+    uint32_t     every;
+    uint32_t     fpsNum;
+    uint32_t     fpsDen;
+
+    mutable std::mutex mutex;
+    uint64_t     written   = 0;
+    bool         failed    = false;     // an error was reported
+
+    // Y4M: frames converted ahead of the next one to write, by readback sequence
+    FILE*        stream    = nullptr;
+    uint32_t     width     = 0;         // of the first frame, 0 before it
+    uint32_t     height    = 0;
+    uint64_t     nextSequence = 0;
+    uint64_t     skipped   = 0;
+    std::map<uint64_t, StreamFrame> pendingFrames;
+};
@@ -0,0 +1,52 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <iomanip>
+
+FramePacer::FramePacer(float marginMs)
+    : marginMs(marginMs) {
+}
+
+double FramePacer::WakeTime() const {
+    const double gpuMs = gpuStats.P95();
+
+    double freeMs = gpuFreeMs;
+
+    for (const InFlight& frame : inFlight) {
+        freeMs = std::max(freeMs, frame.submitMs) + gpuMs;
+    }
+
+    return freeMs - cpuStats.P95() - marginMs;
+}
+
+void FramePacer::Submitted(uint64_t frame, double startMs, double submitMs) {
+    inFlight.push_back({ frame, startMs, submitMs });
+    cpuStats.Add(float(submitMs - startMs));
+}
+
+void FramePacer::Completed(uint64_t frame, float gpuMs, double endMs) {
+    while (!inFlight.empty() && inFlight.front().frame <= frame) {
+        if (inFlight.front().frame == frame) {
+            latency.Add(float(endMs - inFlight.front().startMs));
+        }
+
+        inFlight.pop_front();
+    }
+
+    gpuFreeMs = endMs;
+    gpuStats.Add(gpuMs);
+}
+
+void FramePacer::Print(std::ostream& out, bool paced) const {
+    const FrameTimes::Summary s = latency.Summarize();
+
+    out << "Latency, frame start to GPU done (" << (paced ? "paced" : "not paced") << "): " << s.count << " frames"
+        << std::fixed << std::setprecision(3)
+        << ", avg " << s.avg << " ms, p50 " << s.p50 << ", p95 " << s.p95 << ", p99 " << s.p99 << ", max " << s.max;
+
+    if (paced && s.count) {
+        out << ", slept " << sleptMs / s.count << " ms/frame";
+    }
+
+    out << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "GpuProfiler.h"
+
+#include <cstdint>
+#include <deque>
+#include <ostream>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Just in time frame starts for low latency. Frames are handed over when they start (sample
+// the animation) and are submitted, and again once the GPU has finished them, all in ms on
+// one host clock. The GPU is predicted to be free after every frame still in flight has run
+// for a recent high GPU frame time, none starting before it was submitted; WakeTime is that
+// moment less a recent high CPU start to submit time and a margin, so a frame started then
+// is queued just as the one ahead of it finishes instead of waiting behind it.
+class FramePacer {
+public:
+    explicit FramePacer(float marginMs);
+
+    // when the next frame should start, in the past when it should start right away
+    double WakeTime() const;
+
+    void   Submitted(uint64_t frame, double startMs, double submitMs);
+
+    // gpuMs: the frame's GPU time, endMs: when the GPU finished it; frames ahead of it that
+    // were never completed (no timestamps) are forgotten
+    void   Completed(uint64_t frame, float gpuMs, double endMs);
+
+    void   Slept(double ms) { sleptMs += ms; }
+
+    // paced: whether WakeTime was slept to, or only measured
+    void   Print(std::ostream& out, bool paced) const;
+
+private:
+    struct InFlight {
+        uint64_t frame;
+        double   startMs;
+        double   submitMs;
+    };
+
+    float                marginMs;
+
+    std::deque<InFlight> inFlight;      // in submission order
+    double               gpuFreeMs = 0.0;   // when the last completed frame ended
+
+    RollingStats         gpuStats;
+    RollingStats         cpuStats;      // start to submit
+
+    FrameTimes           latency;       // start to GPU completion, the whole run
+    double               sleptMs   = 0.0;
+};
@@ -0,0 +1,193 @@
+#include "FrameReadback.h"
+#include "ThreadPool.h"
+#include "VulkanUtil.h"
+
+#include <stdexcept>
+
+void FrameReadback::Create(VkDevice dev, const VkPhysicalDeviceMemoryProperties& memoryProps, uint32_t slotCount, uint32_t count,
+                           ThreadPool& pool, Handler imageHandler) {
+    // cached reads are what the workers do; coherent uncached memory is a slow fallback
+    int32_t type = FindMemoryType(memoryProps, ~0u, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    if (type < 0) {
+        type = FindMemoryType(memoryProps, ~0u, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    }
+
+    if (type < 0) {
+        throw std::runtime_error("Could not find host visible memory for readback!");
+    }
+
+    device      = dev;
+    memoryType  = static_cast<uint32_t>(type);
+    coherent    = (memoryProps.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    workers     = &pool;
+    handler     = std::move(imageHandler);
+
+    buffers.reset(new Buffer[count]);
+    bufferCount = count;
+    slots.assign(slotCount, Slot{});
+}
+
+void FrameReadback::Destroy() {
+    for (uint32_t i = 0; i < bufferCount; ++i) {
+        Free(buffers[i]);
+    }
+
+    buffers.reset();
+    bufferCount = 0;
+    slots.clear();
+    device      = VK_NULL_HANDLE;
+}
+
+uint32_t FrameReadback::BytesPerPixel(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+VkBuffer FrameReadback::Acquire(uint32_t slotIndex, VkExtent2D extent, VkFormat format, uint64_t frameNumber) {
+    const uint32_t bytesPerPixel = BytesPerPixel(format);
+    if (!IsEnabled() || bytesPerPixel == 0) {
+        return VK_NULL_HANDLE;
+    }
+
+    Slot& slot = slots[slotIndex];
+    slot.buffer = nullptr;
+
+    Buffer* free = nullptr;
+
+    for (uint32_t i = 0; i < bufferCount && !free; ++i) {
+        if (!buffers[i].busy.load(std::memory_order_acquire)) {
+            free = &buffers[i];
+        }
+    }
+
+    if (!free) {
+        dropped++;
+        return VK_NULL_HANDLE;
+    }
+
+    // nothing uses a free buffer, so growing it needs no wait
+    const VkDeviceSize size = VkDeviceSize(extent.width) * extent.height * bytesPerPixel;
+
+    if (free->size < size) {
+        Free(*free);
+        Allocate(*free, size);
+    }
+
+    free->busy.store(true, std::memory_order_relaxed);
+
+    slot.buffer = free;
+    slot.image  = { static_cast<const uint8_t*>(free->cpuVA), extent.width, extent.height, format, bytesPerPixel, frameNumber, sequence++ };
+
+    return free->buffer;
+}
+
+void FrameReadback::RecordCopy(VkCommandBuffer cmdBuffer, uint32_t slotIndex, VkImage image) const {
+    const Slot& slot = slots[slotIndex];
+
+    VkBufferImageCopy region {
+        0,                                          // bufferOffset
+        0,                                          // bufferRowLength, 0: tightly packed
+        0,                                          // bufferImageHeight
+        { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+        { 0, 0, 0 },
+        { slot.image.width, slot.image.height, 1 }
+    };
+
+    vkCmdCopyImageToBuffer(cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer->buffer, 1, &region);
+}
+
+void FrameReadback::Collect(uint32_t slotIndex) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    Slot& slot = slots[slotIndex];
+
+    if (!slot.buffer) {
+        return;
+    }
+
+    Buffer*       buffer = slot.buffer;
+    ReadbackImage image  = slot.image;
+
+    slot.buffer = nullptr;
+
+    workers->Submit([this, buffer, image] {
+        if (!coherent) {
+            VkMappedMemoryRange range { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, nullptr, buffer->memory, 0, VK_WHOLE_SIZE };
+            vkInvalidateMappedMemoryRanges(device, 1, &range);
+        }
+
+        handler(image);
+
+        buffer->busy.store(false, std::memory_order_release);
+    });
+}
+
+void FrameReadback::Allocate(Buffer& buffer, VkDeviceSize size) {
+    VkBufferCreateInfo createInfo {
+        VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        nullptr,
+        0,
+        size,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_SHARING_MODE_EXCLUSIVE,
+        0,
+        nullptr
+    };
+
+    VkResult result = vkCreateBuffer(device, &createInfo, nullptr, &buffer.buffer);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not create readback buffer!");
+    }
+
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(device, buffer.buffer, &memReqs);
+
+    if (!(memReqs.memoryTypeBits & (1u << memoryType))) {
+        throw std::runtime_error("Could not use host visible memory for a readback buffer!");
+    }
+
+    VkMemoryAllocateInfo allocInfo {
+        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        nullptr,
+        memReqs.size,
+        memoryType
+    };
+
+    result = vkAllocateMemory(device, &allocInfo, nullptr, &buffer.memory);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not allocate readback memory!");
+    }
+
+    vkBindBufferMemory(device, buffer.buffer, buffer.memory, 0);
+
+    // mapped for the buffer's whole life
+    result = vkMapMemory(device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.cpuVA);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not map readback memory!");
+    }
+
+    buffer.size = size;
+}
+
+void FrameReadback::Free(Buffer& buffer) {
+    if (buffer.buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkDestroyBuffer(device, buffer.buffer, nullptr);
+    vkFreeMemory(device, buffer.memory, nullptr);       // unmaps
+
+    buffer.buffer = VK_NULL_HANDLE;
+    buffer.memory = VK_NULL_HANDLE;
+    buffer.cpuVA  = nullptr;
+    buffer.size   = 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+// Pixels of one image read back from the GPU, tightly packed rows. Only valid inside the
+// handler it is given to.
+struct ReadbackImage {
+    const uint8_t* pixels;
+    uint32_t       width;
+    uint32_t       height;
+    VkFormat       format;
+    uint32_t       bytesPerPixel;
+    uint64_t       frameNumber;     // as given to Acquire
+    uint64_t       sequence;        // images read back before this one, no gaps for dropped frames
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copies of rendered images into a ring of host cached buffers, handed to a worker thread
+// once the frame that copied them has finished on the GPU. Like GpuProfiler a frame slot is
+// recorded into with its command buffer and collected after its fence has signalled, so the
+// render thread never waits: a frame is acquired a buffer only if one is free, and dropped
+// (counted) when every buffer is still on the GPU or with a handler. Buffers grow to the
+// largest image they are asked to hold.
+class FrameReadback {
+public:
+    using Handler = std::function<void(const ReadbackImage& image)>;
+
+    // the handler runs on the pool's workers, possibly several at once and out of order
+    void Create(VkDevice device, const VkPhysicalDeviceMemoryProperties& memoryProps, uint32_t slotCount, uint32_t bufferCount,
+                ThreadPool& workers, Handler handler);
+
+    // every handler must have returned (the pool idle)
+    void Destroy();
+    bool IsEnabled() const { return device != VK_NULL_HANDLE; }
+
+    // a buffer for the slot's frame to copy an image of extent into, VK_NULL_HANDLE when the
+    // frame is dropped; the copy is recorded with RecordCopy, after the image is written
+    VkBuffer Acquire(uint32_t slot, VkExtent2D extent, VkFormat format, uint64_t frameNumber);
+
+    // image in TRANSFER_SRC_OPTIMAL; the barrier making the copy visible to the host is the
+    // caller's (RenderGraph: export the buffer as ResourceAccess::HostRead)
+    void RecordCopy(VkCommandBuffer cmdBuffer, uint32_t slot, VkImage image) const;
+
+    // the slot's fence has signalled: its image, if any, goes to a worker
+    void Collect(uint32_t slot);
+
+    uint64_t ReadbackCount() const { return sequence; }
+    uint64_t DroppedCount() const { return dropped; }
+
+    // 8 bit formats with 4 channels, the rest are not read back
+    static uint32_t BytesPerPixel(VkFormat format);
+
+private:
+    struct Buffer {
+        VkBuffer          buffer = VK_NULL_HANDLE;
+        VkDeviceMemory    memory = VK_NULL_HANDLE;
+        void*             cpuVA  = nullptr;
+        VkDeviceSize      size   = 0;
+        std::atomic<bool> busy   { false };     // on the GPU or with a handler
+    };
+
+    struct Slot {
+        Buffer*       buffer = nullptr;     // null: nothing read back in this frame
+        ReadbackImage image {};
+    };
+
+    void Allocate(Buffer& buffer, VkDeviceSize size);
+    void Free(Buffer& buffer);
+
+    VkDevice                  device       = VK_NULL_HANDLE;
+    uint32_t                  memoryType   = 0;
+    bool                      coherent     = true;
+    ThreadPool*               workers      = nullptr;
+    Handler                   handler;
+
+    std::unique_ptr<Buffer[]> buffers;      // not movable, never resized
+    uint32_t                  bufferCount  = 0;
+    std::vector<Slot>         slots;
+
+    uint64_t                  sequence     = 0;
+    uint64_t                  dropped      = 0;
+};
@@ -0,0 +1,420 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+
+const uint32_t NO_QUERY = UINT32_MAX;
+
+// one result per bit, in bit order, which is the order of GpuProfiler::Statistic
+const VkQueryPipelineStatisticFlags STATISTIC_FLAGS =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+const char* const STATISTIC_NAMES[GpuProfiler::StatisticCount] = {
+    "IA verts", "IA prims", "VS invoc", "clip in", "clip out", "FS invoc"
+};
+
+}
+
+void RollingStats::Add(float value) {
+    samples[next] = value;
+    next          = (next + 1) % WINDOW;
+    count         = std::min(count + 1, WINDOW);
+}
+
+float RollingStats::Avg() const {
+    float sum = 0.0f;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        sum += samples[i];
+    }
+
+    return count ? sum / count : 0.0f;
+}
+
+float RollingStats::P95() const {
+    if (count == 0) {
+        return 0.0f;
+    }
+
+    float sorted[WINDOW];
+    std::copy(samples, samples + count, sorted);
+
+    const uint32_t rank = (count * 95 + 99) / 100 - 1;
+    std::nth_element(sorted, sorted + rank, sorted + count);
+
+    return sorted[rank];
+}
+
+float RollingStats::Max() const {
+    return count ? *std::max_element(samples, samples + count) : 0.0f;
+}
+
+void GpuProfiler::Create(VkDevice device, uint32_t slotCount, float periodNs, uint32_t validBits, bool pipelineStatistics) {
+    if (validBits == 0) {
+        return;
+    }
+
+    VkQueryPoolCreateInfo createInfo {
+        VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        nullptr,
+        0,
+        VK_QUERY_TYPE_TIMESTAMP,
+        FirstQuery(slotCount),
+        0
+    };
+
+    VkResult result = vkCreateQueryPool(device, &createInfo, nullptr, &pool);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not create timestamp query pool!");
+    }
+
+    if (pipelineStatistics) {
+        VkQueryPoolCreateInfo statisticsInfo {
+            VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            nullptr,
+            0,
+            VK_QUERY_TYPE_PIPELINE_STATISTICS,
+            FirstStatisticsQuery(slotCount),
+            STATISTIC_FLAGS
+        };
+
+        result = vkCreateQueryPool(device, &statisticsInfo, nullptr, &statisticsPool);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("Could not create pipeline statistics query pool!");
+        }
+    }
+
+    this->device   = device;
+    this->periodNs = periodNs;
+    validMask      = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    slots.resize(slotCount);
+    results.resize(std::max<uint32_t>(MAX_SCOPES_PER_FRAME * 2, MAX_STATISTICS_PER_FRAME * StatisticCount));
+
+    for (Slot& slot : slots) {
+        slot.scopes.reserve(MAX_SCOPES_PER_FRAME);
+        slot.statistics.reserve(MAX_STATISTICS_PER_FRAME);
+    }
+}
+
+void GpuProfiler::Destroy() {
+    if (statisticsPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, statisticsPool, nullptr);
+        statisticsPool = VK_NULL_HANDLE;
+    }
+
+    if (pool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, pool, nullptr);
+        pool = VK_NULL_HANDLE;
+    }
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer cmdBuffer, uint32_t slot) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    vkCmdResetQueryPool(cmdBuffer, pool, FirstQuery(slot), MAX_SCOPES_PER_FRAME * 2);
+
+    if (HasStatistics()) {
+        vkCmdResetQueryPool(cmdBuffer, statisticsPool, FirstStatisticsQuery(slot), MAX_STATISTICS_PER_FRAME);
+    }
+
+    recording              = &slots[slot];
+    recording->scopes.clear();
+    recording->open.clear();
+    recording->queryCount  = 0;
+    recording->statistics.clear();
+    recording->frameNumber = frameNumber++;
+    recording->pending     = false;
+
+    // the frame is scope 0
+    BeginScope(cmdBuffer, "frame");
+}
+
+void GpuProfiler::BeginScope(VkCommandBuffer cmdBuffer, const char* name) {
+    if (!recording) {
+        return;
+    }
+
+    if (recording->scopes.size() == MAX_SCOPES_PER_FRAME) {
+        // still balance the EndScope that comes with it
+        recording->open.push_back(NO_QUERY);
+        return;
+    }
+
+    const uint32_t query = recording->queryCount++;
+
+    vkCmdWriteTimestamp2(cmdBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, pool, FirstQuery(uint32_t(recording - slots.data())) + query);
+
+    recording->open.push_back(static_cast<uint32_t>(recording->scopes.size()));
+    recording->scopes.push_back({ name, static_cast<uint32_t>(recording->open.size() - 1), query, NO_QUERY });
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer cmdBuffer) {
+    if (!recording || recording->open.empty()) {
+        return;
+    }
+
+    const uint32_t scope = recording->open.back();
+    recording->open.pop_back();
+
+    if (scope == NO_QUERY) {
+        return;
+    }
+
+    const uint32_t query = recording->queryCount++;
+
+    vkCmdWriteTimestamp2(cmdBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pool, FirstQuery(uint32_t(recording - slots.data())) + query);
+
+    recording->scopes[scope].endQuery = query;
+}
+
+void GpuProfiler::EndFrame(VkCommandBuffer cmdBuffer) {
+    if (!recording) {
+        return;
+    }
+
+    if (recording->statisticsOpen) {
+        throw std::runtime_error("Could not end a frame with a pipeline statistics scope open!");
+    }
+
+    while (!recording->open.empty()) {
+        EndScope(cmdBuffer);
+    }
+
+    recording->pending = true;
+    recording          = nullptr;
+}
+
+void GpuProfiler::BeginStatistics(VkCommandBuffer cmdBuffer, const char* name, uint64_t pixels) {
+    if (!recording || !HasStatistics()) {
+        return;
+    }
+
+    if (recording->statisticsOpen) {
+        throw std::runtime_error("Could not nest pipeline statistics scopes!");
+    }
+
+    recording->statisticsOpen    = true;
+    recording->statisticsDropped = recording->statistics.size() == MAX_STATISTICS_PER_FRAME;
+
+    if (recording->statisticsDropped) {
+        return;
+    }
+
+    const uint32_t query = FirstStatisticsQuery(uint32_t(recording - slots.data())) + static_cast<uint32_t>(recording->statistics.size());
+
+    vkCmdBeginQuery(cmdBuffer, statisticsPool, query, 0);
+
+    recording->statistics.push_back({ name, pixels });
+}
+
+void GpuProfiler::EndStatistics(VkCommandBuffer cmdBuffer) {
+    if (!recording || !recording->statisticsOpen) {
+        return;
+    }
+
+    recording->statisticsOpen = false;
+
+    if (recording->statisticsDropped) {
+        return;
+    }
+
+    const uint32_t query = FirstStatisticsQuery(uint32_t(recording - slots.data())) + static_cast<uint32_t>(recording->statistics.size()) - 1;
+
+    vkCmdEndQuery(cmdBuffer, statisticsPool, query);
+}
+
+float GpuProfiler::TicksToMs(uint64_t begin, uint64_t end) const {
+    return float((end - begin) & validMask) * periodNs * 1e-6f;
+}
+
+bool GpuProfiler::Collect(uint32_t slotIndex) {
+    if (!IsEnabled()) {
+        return false;
+    }
+
+    Slot& slot   = slots[slotIndex];
+    slot.frameMs = 0.0f;
+
+    if (!slot.pending) {
+        return false;
+    }
+
+    slot.pending = false;
+
+    if (!slot.statistics.empty()) {
+        CollectStatistics(slotIndex);
+    }
+
+    // no WAIT flag: after the fence this never blocks, and a frame that didn't run is skipped
+    VkResult result = vkGetQueryPoolResults(device, pool, FirstQuery(slotIndex), slot.queryCount,
+                                            slot.queryCount * sizeof(uint64_t), results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return false;
+    }
+
+    for (const Scope& scope : slot.scopes) {
+        const float ms = TicksToMs(results[scope.beginQuery], results[scope.endQuery]);
+
+        if (&scope == &slot.scopes.front()) {
+            slot.frameMs  = ms;
+            slot.frameEnd = results[scope.endQuery];
+            frameStats.Add(ms);
+            continue;
+        }
+
+        auto it = std::find_if(scopeStats.begin(), scopeStats.end(),
+                               [&](const NamedStats& named) { return named.name == scope.name && named.depth == scope.depth; });
+
+        if (it == scopeStats.end()) {
+            scopeStats.push_back({ scope.name, scope.depth, RollingStats() });
+            it = scopeStats.end() - 1;
+        }
+
+        it->stats.Add(ms);
+    }
+
+    if (traceFrames) {
+        if (trace.empty()) {
+            traceOrigin = results[slot.scopes.front().beginQuery];
+        }
+
+        for (const Scope& scope : slot.scopes) {
+            trace.push_back({ scope.name, slot.frameNumber, results[scope.beginQuery], results[scope.endQuery] });
+        }
+
+        traceFrameSizes.push_back(slot.scopes.size());
+
+        if (traceFrameSizes.size() > traceFrames) {
+            trace.erase(trace.begin(), trace.begin() + traceFrameSizes.front());
+            traceFrameSizes.pop_front();
+        }
+    }
+
+    return true;
+}
+
+void GpuProfiler::CollectStatistics(uint32_t slotIndex) {
+    const Slot&    slot  = slots[slotIndex];
+    const uint32_t count = static_cast<uint32_t>(slot.statistics.size());
+
+    VkResult result = vkGetQueryPoolResults(device, statisticsPool, FirstStatisticsQuery(slotIndex), count,
+                                            count * StatisticCount * sizeof(uint64_t), results.data(), StatisticCount * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const StatisticsScope& scope  = slot.statistics[i];
+        const uint64_t*        values = results.data() + i * StatisticCount;
+
+        auto it = std::find_if(statisticsStats.begin(), statisticsStats.end(),
+                               [&](const NamedStatistics& named) { return named.name == scope.name; });
+
+        if (it == statisticsStats.end()) {
+            statisticsStats.emplace_back();
+            statisticsStats.back().name = scope.name;
+            it = statisticsStats.end() - 1;
+        }
+
+        for (uint32_t s = 0; s < StatisticCount; ++s) {
+            it->values[s].Add(float(values[s]));
+        }
+
+        if (scope.pixels) {
+            it->fragmentsPerPixel.Add(float(values[FragmentInvocations]) / float(scope.pixels));
+        }
+    }
+}
+
+float GpuProfiler::FrameMs(uint32_t slot) const {
+    return IsEnabled() ? slots[slot].frameMs : 0.0f;
+}
+
+void GpuProfiler::Report(std::ostream& out) const {
+    if (frameStats.Empty()) {
+        return;
+    }
+
+    auto line = [&](const std::string& name, const RollingStats& stats) {
+        out << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(9) << stats.Avg() << std::setw(9) << stats.P95() << std::setw(9) << stats.Max() << '\n';
+    };
+
+    out << std::left << std::setw(24) << "GPU ms" << std::right
+        << std::setw(9) << "avg" << std::setw(9) << "p95" << std::setw(9) << "max" << '\n';
+
+    line("frame", frameStats);
+
+    for (const NamedStats& named : scopeStats) {
+        line(std::string(2 * named.depth, ' ') + named.name, named.stats);
+    }
+
+    if (!statisticsStats.empty()) {
+        // averages per frame; clip out / in below one is what the clipper rejected
+        out << std::left << std::setw(24) << "GPU statistics" << std::right;
+        for (const char* name : STATISTIC_NAMES) {
+            out << std::setw(11) << name;
+        }
+        out << std::setw(10) << "FS/px" << '\n';
+
+        for (const NamedStatistics& named : statisticsStats) {
+            out << std::left << std::setw(24) << named.name << std::right << std::setprecision(0);
+            for (const RollingStats& value : named.values) {
+                out << std::setw(11) << value.Avg();
+            }
+
+            out << std::setprecision(2) << std::setw(10);
+            if (named.fragmentsPerPixel.Empty()) {
+                out << "-";
+            }
+            else {
+                out << named.fragmentsPerPixel.Avg();
+            }
+            out << '\n';
+        }
+    }
+
+    out << std::defaultfloat << std::flush;
+}
+
+void GpuProfiler::StartTrace(uint32_t maxFrames) {
+    traceFrames = maxFrames;
+    trace.clear();
+    traceFrameSizes.clear();
+}
+
+void GpuProfiler::WriteTrace(const std::string& path) const {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Could not open " + path);
+    }
+
+    // Chrome trace event format, complete events in microseconds on one GPU track
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+    file << std::fixed << std::setprecision(3);
+
+    for (const TraceEvent& event : trace) {
+        const double ts  = double((event.begin - traceOrigin) & validMask) * periodNs * 1e-3;
+        const double dur = double((event.end - event.begin) & validMask) * periodNs * 1e-3;
+
+        file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+             << ",\"ts\":" << ts << ",\"dur\":" << dur
+             << ",\"args\":{\"frame\":" << event.frameNumber << "}}";
+    }
+
+    file << "\n]}\n";
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Last N samples of one measurement (ms, counts).
+class RollingStats {
+public:
+    static constexpr uint32_t WINDOW = 240;
+
+    void  Add(float value);
+
+    float Avg() const;
+    float P95() const;
+    float Max() const;
+    bool  Empty() const { return count == 0; }
+
+private:
+    float    samples[WINDOW] = {};
+    uint32_t next  = 0;
+    uint32_t count = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// GPU timestamps around a frame and the scopes inside it, one query range per frame slot.
+// A slot is recorded into with its command buffer and read back with Collect once that
+// command buffer's fence has signalled, so nothing ever waits on a query. Scopes nest and
+// are keyed by name, which must outlive the profiler (string literals, graph pass names).
+// Pipeline statistics scopes count what a group of draws did in the same frames; they can
+// not nest and must begin and end in the same render pass instance, or both outside one.
+class GpuProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME     = 32;    // the frame itself included
+    static constexpr uint32_t MAX_STATISTICS_PER_FRAME = 8;
+
+    // in query result order
+    enum Statistic : uint32_t {
+        InputVertices,
+        InputPrimitives,
+        VertexInvocations,
+        ClippingInvocations,        // primitives that reached clipping, after culling in hardware
+        ClippingPrimitives,         // primitives that came out of it
+        FragmentInvocations,
+
+        StatisticCount
+    };
+
+    // validBits from the queue family's timestampValidBits, periodNs from the device limits;
+    // pipelineStatistics with the device's pipelineStatisticsQuery feature enabled
+    void Create(VkDevice device, uint32_t slotCount, float periodNs, uint32_t validBits, bool pipelineStatistics);
+    void Destroy();
+    bool IsEnabled() const { return pool != VK_NULL_HANDLE; }
+
+    // all no-ops when disabled; scopes past MAX_SCOPES_PER_FRAME are dropped
+    void BeginFrame(VkCommandBuffer cmdBuffer, uint32_t slot);
+    void BeginScope(VkCommandBuffer cmdBuffer, const char* name);
+    void EndScope(VkCommandBuffer cmdBuffer);
+    void EndFrame(VkCommandBuffer cmdBuffer);
+
+    // pixels: of the target, to report fragment invocations per pixel; 0 leaves that out
+    void BeginStatistics(VkCommandBuffer cmdBuffer, const char* name, uint64_t pixels = 0);
+    void EndStatistics(VkCommandBuffer cmdBuffer);
+    bool HasStatistics() const { return statisticsPool != VK_NULL_HANDLE; }
+
+    // reads the slot's last frame, false when it has nothing (new) to give
+    bool Collect(uint32_t slot);
+
+    // of the slot's last collected frame, 0 when Collect found nothing
+    float FrameMs(uint32_t slot) const;
+
+    // the device timestamp the slot's last collected frame ended at, in ticks
+    uint64_t FrameEndTicks(uint32_t slot) const { return slots[slot].frameEnd; }
+
+    const RollingStats& FrameStats() const { return frameStats; }
+
+    // avg / p95 / max of the frame and every scope seen so far, then average statistics
+    void Report(std::ostream& out) const;
+
+    // keeps the last maxFrames collected frames for WriteTrace
+    void StartTrace(uint32_t maxFrames);
+    void WriteTrace(const std::string& path) const;
+
+private:
+    struct Scope {
+        const char* name;
+        uint32_t    depth;
+        uint32_t    beginQuery;     // within the slot
+        uint32_t    endQuery;
+    };
+
+    struct StatisticsScope {
+        const char* name;
+        uint64_t    pixels;
+    };
+
+    struct Slot {
+        std::vector<Scope>    scopes;
+        std::vector<uint32_t> open;         // indices into scopes
+        uint32_t              queryCount = 0;
+
+        std::vector<StatisticsScope> statistics;
+        bool                         statisticsOpen    = false;
+        bool                         statisticsDropped = false;    // the open one, past the limit
+
+        uint64_t              frameNumber = 0;
+        bool                  pending    = false;
+        float                 frameMs    = 0.0f;
+        uint64_t              frameEnd   = 0;
+    };
+
+    struct NamedStats {
+        const char*  name;
+        uint32_t     depth;
+        RollingStats stats;
+    };
+
+    struct NamedStatistics {
+        const char*  name;
+        RollingStats values[StatisticCount];
+        RollingStats fragmentsPerPixel;
+    };
+
+    struct TraceEvent {
+        const char* name;
+        uint64_t    frameNumber;
+        uint64_t    begin;          // ticks
+        uint64_t    end;
+    };
+
+    uint32_t FirstQuery(uint32_t slot) const { return slot * MAX_SCOPES_PER_FRAME * 2; }
+    uint32_t FirstStatisticsQuery(uint32_t slot) const { return slot * MAX_STATISTICS_PER_FRAME; }
+    void     CollectStatistics(uint32_t slotIndex);
+    float    TicksToMs(uint64_t begin, uint64_t end) const;
+
+    VkDevice          device         = VK_NULL_HANDLE;
+    VkQueryPool       pool           = VK_NULL_HANDLE;
+    VkQueryPool       statisticsPool = VK_NULL_HANDLE;
+    float             periodNs       = 1.0f;
+    uint64_t          validMask      = ~0ull;
+
+    std::vector<Slot> slots;
+    Slot*             recording      = nullptr;
+    uint64_t          frameNumber    = 0;
+
+    RollingStats            frameStats;
+    std::vector<NamedStats> scopeStats;     // in order of first appearance
+    std::vector<uint64_t>   results;
+
+    std::vector<NamedStatistics> statisticsStats;   // in order of first appearance
+
+    uint32_t               traceFrames = 0;    // 0: not tracing
+    uint64_t               traceOrigin = 0;
+    std::deque<TraceEvent> trace;
+    std::deque<size_t>     traceFrameSizes;
+};
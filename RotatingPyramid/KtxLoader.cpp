@@ -0,0 +1,459 @@
+#include "KtxLoader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// header, index and the first level entry, all little endian
+constexpr size_t HEADER_SIZE      = 80;
+constexpr size_t LEVEL_ENTRY_SIZE = 24;
+
+enum SupercompressionScheme : uint32_t {
+    SUPERCOMPRESSION_NONE    = 0,
+    SUPERCOMPRESSION_BASISLZ = 1,
+    SUPERCOMPRESSION_ZSTD    = 2,
+    SUPERCOMPRESSION_ZLIB    = 3,
+};
+
+template<typename T>
+T ReadLe(const uint8_t* p) {
+    T v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        v |= static_cast<T>(p[i]) << (8 * i);
+    }
+    return v;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BC1
+
+void Rgb565(uint16_t c, uint8_t rgb[3]) {
+    uint8_t r = (c >> 11) & 0x1F;
+    uint8_t g = (c >> 5)  & 0x3F;
+    uint8_t b =  c        & 0x1F;
+
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+void DecodeBc1Block(const uint8_t* block, bool punchThrough, uint8_t out[16][4]) {
+    const uint16_t c0      = ReadLe<uint16_t>(block);
+    const uint16_t c1      = ReadLe<uint16_t>(block + 2);
+    const uint32_t indices = ReadLe<uint32_t>(block + 4);
+
+    uint8_t palette[4][4];
+    Rgb565(c0, palette[0]);
+    Rgb565(c1, palette[1]);
+
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+    for (int c = 0; c < 3; ++c) {
+        if (c0 > c1) {
+            palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+        else {
+            palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+            palette[3][c] = 0;
+        }
+    }
+
+    // the fourth entry is transparent black only in the RGBA variant
+    if (c0 <= c1 && punchThrough) {
+        palette[3][3] = 0;
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        std::memcpy(out[i], palette[(indices >> (2 * i)) & 3], 4);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BC7
+
+struct Bc7Mode {
+    uint8_t subsets;
+    uint8_t partitionBits;
+    uint8_t rotationBits;
+    uint8_t indexSelectionBits;
+    uint8_t colorBits;
+    uint8_t alphaBits;
+    uint8_t endpointPBits;      // one per endpoint
+    uint8_t sharedPBits;        // one per subset
+    uint8_t indexBits;
+    uint8_t indexBits2;
+};
+
+const Bc7Mode BC7_MODES[8] = {
+    { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+    { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+    { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+    { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+    { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+    { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+    { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+    { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+const uint8_t BC7_PARTITIONS_2[64][16] = {
+    { 0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1 }, { 0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1 }, { 0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1 }, { 0,0,0,1,0,0,1,1,0,0,1,1,0,1,1,1 },
+    { 0,0,0,0,0,0,0,1,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,1,0,0,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,0,1,1,0,1,1,1 },
+    { 0,0,0,0,0,0,0,0,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,1,0,1,1,1 },
+    { 0,0,0,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1 }, { 0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1 },
+    { 0,0,0,0,1,0,0,0,1,1,1,0,1,1,1,1 }, { 0,1,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,1,0 }, { 0,1,1,1,0,0,1,1,0,0,0,1,0,0,0,0 },
+    { 0,0,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,1,0,0,1,1,1,0 }, { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,1,0,0,1,1,0,0,1,1,0,0,0,1 },
+    { 0,0,1,1,0,0,0,1,0,0,0,1,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0 }, { 0,0,1,1,0,1,1,0,0,1,1,0,1,1,0,0 },
+    { 0,0,0,1,0,1,1,1,1,1,1,0,1,0,0,0 }, { 0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0 }, { 0,1,1,1,0,0,0,1,1,0,0,0,1,1,1,0 }, { 0,0,1,1,1,0,0,1,1,0,0,1,1,1,0,0 },
+    { 0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1 }, { 0,0,0,0,1,1,1,1,0,0,0,0,1,1,1,1 }, { 0,1,0,1,1,0,1,0,0,1,0,1,1,0,1,0 }, { 0,0,1,1,0,0,1,1,1,1,0,0,1,1,0,0 },
+    { 0,0,1,1,1,1,0,0,0,0,1,1,1,1,0,0 }, { 0,1,0,1,0,1,0,1,1,0,1,0,1,0,1,0 }, { 0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1 }, { 0,1,0,1,1,0,1,0,1,0,1,0,0,1,0,1 },
+    { 0,1,1,1,0,0,1,1,1,1,0,0,1,1,1,0 }, { 0,0,0,1,0,0,1,1,1,1,0,0,1,0,0,0 }, { 0,0,1,1,0,0,1,0,0,1,0,0,1,1,0,0 }, { 0,0,1,1,1,0,1,1,1,1,0,1,1,1,0,0 },
+    { 0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0 }, { 0,0,1,1,1,1,0,0,1,1,0,0,0,0,1,1 }, { 0,1,1,0,0,1,1,0,1,0,0,1,1,0,0,1 }, { 0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0 },
+    { 0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,0 }, { 0,0,1,0,0,1,1,1,0,0,1,0,0,0,0,0 }, { 0,0,0,0,0,0,1,0,0,1,1,1,0,0,1,0 }, { 0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,0 },
+    { 0,1,1,0,1,1,0,0,1,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,1,0,0,1,1,1,0,0 }, { 0,0,1,1,1,0,0,1,1,1,0,0,0,1,1,0 },
+    { 0,1,1,0,1,1,0,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,0,0,1,1,1,0,0,1 }, { 0,1,1,1,1,1,1,0,1,0,0,0,0,0,0,1 }, { 0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,1 },
+    { 0,0,0,0,1,1,1,1,0,0,1,1,0,0,1,1 }, { 0,0,1,1,0,0,1,1,1,1,1,1,0,0,0,0 }, { 0,0,1,0,0,0,1,0,1,1,1,0,1,1,1,0 }, { 0,1,0,0,0,1,0,0,0,1,1,1,0,1,1,1 },
+};
+
+const uint8_t BC7_PARTITIONS_3[64][16] = {
+    { 0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2 }, { 0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1 }, { 0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1 }, { 0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1 },
+    { 0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2 }, { 0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2 }, { 0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1 }, { 0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1 },
+    { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2 }, { 0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2 },
+    { 0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2 }, { 0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2 }, { 0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2 }, { 0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0 },
+    { 0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2 }, { 0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0 }, { 0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2 }, { 0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1 },
+    { 0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2 }, { 0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1 }, { 0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2 }, { 0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0 },
+    { 0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0 }, { 0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2 }, { 0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0 }, { 0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1 },
+    { 0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2 }, { 0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2 }, { 0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1 }, { 0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1 },
+    { 0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2 }, { 0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1 }, { 0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2 }, { 0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0 },
+    { 0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0 }, { 0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0 }, { 0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0 }, { 0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1 },
+    { 0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1 }, { 0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1 }, { 0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2 },
+    { 0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1 }, { 0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1 }, { 0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1 }, { 0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1 },
+    { 0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2 }, { 0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1 }, { 0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2 }, { 0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2 },
+    { 0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2 }, { 0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2 }, { 0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2 },
+    { 0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2 }, { 0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2 }, { 0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2 }, { 0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2 },
+    { 0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1 }, { 0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2 }, { 0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2 }, { 0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0 },
+};
+
+// pixel whose index drops its top bit, per subset after the first (which is always pixel 0)
+const uint8_t BC7_ANCHORS_2[64] = {
+    15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15, 15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+    15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,  6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15,
+};
+
+const uint8_t BC7_ANCHORS_3A[64] = {
+     3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,  3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+     8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,  3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3,
+};
+
+const uint8_t BC7_ANCHORS_3B[64] = {
+    15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8, 15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+    15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8, 15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8,
+};
+
+const uint8_t BC7_WEIGHTS_2[4]  = { 0, 21, 43, 64 };
+const uint8_t BC7_WEIGHTS_3[8]  = { 0, 9, 18, 27, 37, 46, 55, 64 };
+const uint8_t BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+class BlockBits {
+public:
+    explicit BlockBits(const uint8_t* block) : block(block) {}
+
+    uint32_t Read(uint32_t count) {
+        uint32_t v = 0;
+        for (uint32_t i = 0; i < count; ++i, ++pos) {
+            v |= ((block[pos >> 3] >> (pos & 7)) & 1u) << i;
+        }
+        return v;
+    }
+
+    void Skip(uint32_t count) { pos += count; }
+
+private:
+    const uint8_t* block;
+    uint32_t       pos = 0;
+};
+
+uint8_t Bc7Interpolate(uint8_t e0, uint8_t e1, uint32_t index, uint32_t indexBits) {
+    const uint8_t* weights = (indexBits == 2) ? BC7_WEIGHTS_2 : (indexBits == 3) ? BC7_WEIGHTS_3 : BC7_WEIGHTS_4;
+    const uint32_t w       = weights[index];
+
+    return static_cast<uint8_t>(((64 - w) * e0 + w * e1 + 32) >> 6);
+}
+
+// endpoint with its p-bit (if any) below the stored bits, then replicated up to 8 bits
+uint8_t Bc7Unquantize(uint32_t value, uint32_t bits) {
+    value <<= (8 - bits);
+    return static_cast<uint8_t>(value | (value >> bits));
+}
+
+void DecodeBc7Block(const uint8_t* block, uint8_t out[16][4]) {
+    uint32_t mode = 0;
+    while (mode < 8 && !(block[0] & (1u << mode))) {
+        mode++;
+    }
+
+    // reserved mode, decodes to transparent black
+    if (mode == 8) {
+        std::memset(out, 0, 16 * 4);
+        return;
+    }
+
+    const Bc7Mode& m = BC7_MODES[mode];
+
+    BlockBits bits(block);
+    bits.Skip(mode + 1);
+
+    const uint32_t partition      = bits.Read(m.partitionBits);
+    const uint32_t rotation       = bits.Read(m.rotationBits);
+    const uint32_t indexSelection = bits.Read(m.indexSelectionBits);
+
+    const uint32_t endpointCount = 2u * m.subsets;
+
+    uint32_t raw[6][4] = {};
+    for (uint32_t c = 0; c < 3; ++c) {
+        for (uint32_t e = 0; e < endpointCount; ++e) {
+            raw[e][c] = bits.Read(m.colorBits);
+        }
+    }
+
+    for (uint32_t e = 0; e < endpointCount && m.alphaBits; ++e) {
+        raw[e][3] = bits.Read(m.alphaBits);
+    }
+
+    uint32_t pBits[6] = {};
+    if (m.endpointPBits) {
+        for (uint32_t e = 0; e < endpointCount; ++e) {
+            pBits[e] = bits.Read(1);
+        }
+    }
+    else if (m.sharedPBits) {
+        for (uint32_t s = 0; s < m.subsets; ++s) {
+            pBits[2 * s] = pBits[2 * s + 1] = bits.Read(1);
+        }
+    }
+
+    const uint32_t hasPBit = (m.endpointPBits || m.sharedPBits) ? 1 : 0;
+
+    uint8_t endpoints[6][4];
+    for (uint32_t e = 0; e < endpointCount; ++e) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            endpoints[e][c] = Bc7Unquantize((raw[e][c] << hasPBit) | pBits[e], m.colorBits + hasPBit);
+        }
+
+        endpoints[e][3] = m.alphaBits ? Bc7Unquantize((raw[e][3] << hasPBit) | pBits[e], m.alphaBits + hasPBit) : 255;
+    }
+
+    auto subsetOf = [&](uint32_t i) -> uint32_t {
+        return (m.subsets == 2) ? BC7_PARTITIONS_2[partition][i]
+             : (m.subsets == 3) ? BC7_PARTITIONS_3[partition][i]
+             : 0;
+    };
+
+    auto isAnchor = [&](uint32_t i) {
+        return i == 0
+            || (m.subsets == 2 && i == BC7_ANCHORS_2[partition])
+            || (m.subsets == 3 && (i == BC7_ANCHORS_3A[partition] || i == BC7_ANCHORS_3B[partition]));
+    };
+
+    uint32_t indices[16];
+    for (uint32_t i = 0; i < 16; ++i) {
+        indices[i] = bits.Read(m.indexBits - (isAnchor(i) ? 1 : 0));
+    }
+
+    uint32_t indices2[16] = {};
+    for (uint32_t i = 0; i < 16 && m.indexBits2; ++i) {
+        indices2[i] = bits.Read(m.indexBits2 - (i == 0 ? 1 : 0));
+    }
+
+    // modes 4 and 5 carry a second index set for alpha, mode 4 can swap which one colour uses
+    const bool     swapIndices = m.indexBits2 && indexSelection;
+    const uint32_t* colorIdx   = swapIndices ? indices2 : indices;
+    const uint32_t* alphaIdx   = (m.indexBits2 && !indexSelection) ? indices2 : indices;
+    const uint32_t colorBits   = swapIndices ? m.indexBits2 : m.indexBits;
+    const uint32_t alphaBits   = (m.indexBits2 && !indexSelection) ? m.indexBits2 : m.indexBits;
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        const uint8_t* e0 = endpoints[2 * subsetOf(i)];
+        const uint8_t* e1 = endpoints[2 * subsetOf(i) + 1];
+
+        for (uint32_t c = 0; c < 3; ++c) {
+            out[i][c] = Bc7Interpolate(e0[c], e1[c], colorIdx[i], colorBits);
+        }
+
+        out[i][3] = Bc7Interpolate(e0[3], e1[3], alphaIdx[i], alphaBits);
+
+        if (rotation) {
+            std::swap(out[i][3], out[i][rotation - 1]);
+        }
+    }
+}
+
+}
+
+bool KtxLoader::IsKtx2(const std::string& path) {
+    const std::string ext = ".ktx2";
+
+    if (path.size() < ext.size()) {
+        return false;
+    }
+
+    return std::equal(ext.begin(), ext.end(), path.end() - ext.size(), [](char a, char b) {
+        return a == static_cast<char>(std::tolower(static_cast<unsigned char>(b)));
+    });
+}
+
+KtxLoader::Texture KtxLoader::Load(const std::string& path) {
+    MappedFile file(path);
+
+    Texture texture = Parse(file.Data(), file.Size(), path);
+    texture.file    = std::move(file);
+
+    return texture;
+}
+
+KtxLoader::Texture KtxLoader::Parse(const uint8_t* data, size_t size, const std::string& path) {
+    Texture texture;
+    texture.data = data;
+    texture.size = size;
+
+    if (!data || size < HEADER_SIZE || std::memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        throw std::runtime_error("Not a KTX2 file: " + path);
+    }
+
+    const uint32_t vkFormat         = ReadLe<uint32_t>(data + 12);
+    const uint32_t pixelWidth       = ReadLe<uint32_t>(data + 20);
+    const uint32_t pixelHeight      = ReadLe<uint32_t>(data + 24);
+    const uint32_t pixelDepth       = ReadLe<uint32_t>(data + 28);
+    const uint32_t layerCount       = ReadLe<uint32_t>(data + 32);
+    const uint32_t faceCount        = ReadLe<uint32_t>(data + 36);
+    const uint32_t levelCount       = std::max(ReadLe<uint32_t>(data + 40), 1u);
+    const uint32_t supercompression = ReadLe<uint32_t>(data + 44);
+
+    if (supercompression == SUPERCOMPRESSION_BASISLZ || vkFormat == VK_FORMAT_UNDEFINED) {
+        throw std::runtime_error("KTX2 file " + path + " needs a Basis Universal transcoder, which is not available");
+    }
+
+    if (supercompression != SUPERCOMPRESSION_NONE) {
+        throw std::runtime_error("KTX2 file " + path + " is zstd/zlib supercompressed, which is not supported");
+    }
+
+    if (pixelHeight == 0 || pixelDepth > 1 || layerCount > 1 || faceCount != 1) {
+        throw std::runtime_error("KTX2 file " + path + " is not a plain 2D texture");
+    }
+
+    texture.format = static_cast<VkFormat>(vkFormat);
+    texture.width  = pixelWidth;
+    texture.height = pixelHeight;
+
+    const uint32_t blockSize = BlockSize(texture.format);
+    if (blockSize == 0) {
+        throw std::runtime_error("KTX2 file " + path + " has an unsupported format " + std::to_string(vkFormat));
+    }
+
+    if (size < HEADER_SIZE + size_t(levelCount) * LEVEL_ENTRY_SIZE) {
+        throw std::runtime_error("KTX2 file " + path + " is truncated");
+    }
+
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        const uint8_t* entry = data + HEADER_SIZE + size_t(i) * LEVEL_ENTRY_SIZE;
+
+        Level level {
+            std::max(pixelWidth >> i, 1u),
+            std::max(pixelHeight >> i, 1u),
+            ReadLe<uint64_t>(entry),
+            ReadLe<uint64_t>(entry + 8),
+        };
+
+        const uint32_t extent   = BlockExtent(texture.format);
+        const uint64_t expected = uint64_t((level.width + extent - 1) / extent) * ((level.height + extent - 1) / extent) * blockSize;
+
+        if (level.size != expected || level.offset > size || level.size > size - level.offset) {
+            throw std::runtime_error("KTX2 file " + path + " has a bad level " + std::to_string(i));
+        }
+
+        texture.levels.push_back(level);
+    }
+
+    return texture;
+}
+
+uint32_t KtxLoader::BlockSize(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return 4;
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        return 8;
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+    case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+uint32_t KtxLoader::BlockExtent(VkFormat format) {
+    return (format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB) ? 1 : 4;
+}
+
+VkFormat KtxLoader::DecodedFormat(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return VK_FORMAT_R8G8B8A8_SRGB;
+    default:
+        return VK_FORMAT_UNDEFINED;
+    }
+}
+
+void KtxLoader::Decode(VkFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba) {
+    const uint32_t blockSize = BlockSize(format);
+
+    const bool bc7          = (format == VK_FORMAT_BC7_UNORM_BLOCK || format == VK_FORMAT_BC7_SRGB_BLOCK);
+    const bool punchThrough = (format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK);
+
+    if (DecodedFormat(format) == VK_FORMAT_UNDEFINED) {
+        throw std::runtime_error("No CPU decoder for format " + std::to_string(format));
+    }
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+
+    uint8_t texels[16][4];
+
+    for (uint32_t by = 0; by < blocksY; ++by) {
+        for (uint32_t bx = 0; bx < blocksX; ++bx) {
+            const uint8_t* block = blocks + (size_t(by) * blocksX + bx) * blockSize;
+
+            if (bc7) {
+                DecodeBc7Block(block, texels);
+            }
+            else {
+                DecodeBc1Block(block, punchThrough, texels);
+            }
+
+            // partial blocks at the right and bottom edges
+            for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y) {
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x) {
+                    std::memcpy(rgba + ((size_t(by) * 4 + y) * width + bx * 4 + x) * 4, texels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// KTX2 container reader for 2D block compressed textures (BC1, BC7, ASTC 4x4) and the plain
+// RGBA8 chains PackTool writes. Level data stays in the memory mapped file or asset pack, so
+// mips go to the staging buffer in a single copy. Supercompressed files (BasisLZ, zstd,
+// zlib) and UASTC are rejected, there is no transcoder in the tree.
+class KtxLoader {
+public:
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;    // bytes into the container
+        uint64_t size;
+    };
+
+    struct Texture {
+        MappedFile           file;          // when loaded from a loose file
+        std::vector<uint8_t> storage;       // when unpacked from a compressed asset
+        const uint8_t*       data   = nullptr;
+        size_t               size   = 0;
+
+        VkFormat           format = VK_FORMAT_UNDEFINED;
+        uint32_t           width  = 0;
+        uint32_t           height = 0;
+        std::vector<Level> levels;      // largest first, offsets into data
+
+        const uint8_t* LevelData(size_t level) const { return data + levels[level].offset; }
+    };
+
+    // by extension, the texture path may also be a PNG
+    static bool    IsKtx2(const std::string& path);
+
+    static Texture Load(const std::string& path);
+
+    // a container already in memory, which has to outlive the texture unless moved into storage
+    static Texture Parse(const uint8_t* data, size_t size, const std::string& path);
+
+    // bytes per block, 0 for formats the loader doesn't take
+    static uint32_t BlockSize(VkFormat format);
+
+    // texels per block side, 4 for the compressed formats
+    static uint32_t BlockExtent(VkFormat format);
+
+    // CPU fallback for devices that can't sample the format: the RGBA8 format Decode
+    // produces, VK_FORMAT_UNDEFINED when there is no decoder (ASTC)
+    static VkFormat DecodedFormat(VkFormat format);
+
+    // one level of blocks to tightly packed width x height RGBA8
+    static void     Decode(VkFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba);
+};
@@ -0,0 +1,129 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+#ifdef _WIN32
+        std::swap(file, other.file);
+        std::swap(mapping, other.mapping);
+#else
+        std::swap(fd, other.fd);
+#endif
+    }
+
+    return *this;
+}
+
+void MappedFile::Open(const std::string& path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open file " + path);
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        CloseHandle(hFile);
+        throw std::runtime_error("Could not query size of " + path);
+    }
+
+    file = hFile;
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    // an empty file cannot be mapped, leave data null but keep the handle
+    if (size == 0) {
+        return;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!hMapping) {
+        Close();
+        throw std::runtime_error("Could not create file mapping for " + path);
+    }
+
+    mapping = hMapping;
+
+    data = static_cast<const uint8_t*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        Close();
+        throw std::runtime_error("Could not map view of " + path);
+    }
+#else
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file " + path);
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        Close();
+        throw std::runtime_error("Could not query size of " + path);
+    }
+
+    size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        return;
+    }
+
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED) {
+        Close();
+        throw std::runtime_error("Could not map " + path);
+    }
+
+    madvise(ptr, size, MADV_SEQUENTIAL);
+
+    data = static_cast<const uint8_t*>(ptr);
+#endif
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+
+    if (mapping) {
+        CloseHandle(static_cast<HANDLE>(mapping));
+    }
+
+    if (file) {
+        CloseHandle(static_cast<HANDLE>(file));
+    }
+
+    file    = nullptr;
+    mapping = nullptr;
+#else
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    fd = -1;
+#endif
+
+    data = nullptr;
+    size = 0;
+}
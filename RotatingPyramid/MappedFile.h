@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Read-only memory mapping of a whole file. Pages are faulted in by the OS on first
+// touch, so large assets are never copied into an intermediate heap buffer.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { Open(path); }
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    void Open(const std::string& path);
+    void Close();
+
+    const uint8_t* Data() const { return data; }
+    size_t         Size() const { return size; }
+    bool           IsOpen() const { return data != nullptr; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t         size = 0;
+
+#ifdef _WIN32
+    void*          file    = nullptr;
+    void*          mapping = nullptr;
+#else
+    int            fd      = -1;
+#endif
+};
@@ -0,0 +1,1132 @@
+#include "MeshLoader.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region MeshData
+
+VkDeviceSize MeshData::IndexBufferSize() const {
+    return indices.size() * (IndexType() == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+}
+
+void MeshData::WriteIndices(void* dst) const {
+    if (IndexType() == VK_INDEX_TYPE_UINT32) {
+        std::memcpy(dst, indices.data(), indices.size() * sizeof(uint32_t));
+        return;
+    }
+
+    uint16_t* out = static_cast<uint16_t*>(dst);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        out[i] = static_cast<uint16_t>(indices[i]);
+    }
+}
+
+void MeshData::ComputeBounds() {
+    if (vertices.empty()) {
+        std::fill(std::begin(boundsMin), std::end(boundsMin), 0.0f);
+        std::fill(std::begin(boundsMax), std::end(boundsMax), 0.0f);
+        return;
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        boundsMin[c] = vertices[0].position[c];
+        boundsMax[c] = vertices[0].position[c];
+    }
+
+    for (auto& v : vertices) {
+        for (int c = 0; c < 3; ++c) {
+            boundsMin[c] = std::min(boundsMin[c], v.position[c]);
+            boundsMax[c] = std::max(boundsMax[c], v.position[c]);
+        }
+    }
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region Helpers
+
+namespace {
+
+// splits [0, count) into one contiguous range per core, rethrows the first worker exception
+template<typename Fn>
+void ParallelFor(size_t count, size_t minBatch, Fn&& fn) {
+    size_t hw      = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t workers = std::min(hw, (count + minBatch - 1) / std::max<size_t>(1, minBatch));
+
+    if (workers <= 1) {
+        fn(size_t(0), count, size_t(0));
+        return;
+    }
+
+    size_t batch = (count + workers - 1) / workers;
+
+    std::vector<std::thread>        threads;
+    std::vector<std::exception_ptr> errors(workers);
+
+    threads.reserve(workers);
+
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w] {
+            try {
+                size_t begin = w * batch;
+                size_t end   = std::min(count, begin + batch);
+                if (begin < end) {
+                    fn(begin, end, w);
+                }
+            }
+            catch (...) {
+                errors[w] = std::current_exception();
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+inline uint64_t Mix64(uint64_t k) {
+    // murmur3 finalizer
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+struct U64Hash {
+    size_t operator()(uint64_t k) const { return static_cast<size_t>(Mix64(k)); }
+};
+
+struct U64Equal {
+    bool operator()(uint64_t a, uint64_t b) const { return a == b; }
+};
+
+struct VertexHash {
+    size_t operator()(const Vertex& v) const {
+        uint64_t words[sizeof(Vertex) / sizeof(uint64_t)];
+        std::memcpy(words, &v, sizeof(Vertex));
+
+        uint64_t h = 0x9e3779b97f4a7c15ULL;
+        for (uint64_t w : words) {
+            h = Mix64(h ^ w);
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const Vertex& a, const Vertex& b) const { return std::memcmp(&a, &b, sizeof(Vertex)) == 0; }
+};
+
+// open addressing, linear probing, power of two table; maps a key to the index of its first occurrence
+template<typename Key, typename Hash, typename Equal>
+class FlatIndexMap {
+public:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    explicit FlatIndexMap(size_t expected) {
+        Rehash(std::max<size_t>(16, expected));
+    }
+
+    uint32_t FindOrInsert(const Key& key, uint32_t value) {
+        if ((count + 1) * 2 > values.size()) {
+            Rehash(values.size() * 2);
+        }
+
+        size_t slot = Hash{}(key) & mask;
+        for (;;) {
+            if (values[slot] == EMPTY) {
+                keys[slot]   = key;
+                values[slot] = value;
+                count++;
+                return value;
+            }
+
+            if (Equal{}(keys[slot], key)) {
+                return values[slot];
+            }
+
+            slot = (slot + 1) & mask;
+        }
+    }
+
+private:
+    void Rehash(size_t minCapacity) {
+        size_t capacity = 16;
+        while (capacity < minCapacity) {
+            capacity <<= 1;
+        }
+
+        std::vector<Key>      oldKeys;
+        std::vector<uint32_t> oldValues;
+
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+
+        keys.resize(capacity);
+        values.assign(capacity, EMPTY);
+        mask = capacity - 1;
+
+        for (size_t i = 0; i < oldValues.size(); ++i) {
+            if (oldValues[i] == EMPTY) {
+                continue;
+            }
+
+            size_t slot = Hash{}(oldKeys[i]) & mask;
+            while (values[slot] != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+
+            keys[slot]   = oldKeys[i];
+            values[slot] = oldValues[i];
+        }
+    }
+
+    std::vector<Key>      keys;
+    std::vector<uint32_t> values;
+    size_t                mask  = 0;
+    size_t                count = 0;
+};
+
+std::string LowerExtension(const std::string& path) {
+    auto dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return {};
+    }
+
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext;
+}
+
+std::string DirectoryOf(const std::string& path) {
+    auto slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region OBJ
+
+namespace {
+
+struct ObjCorner {
+    static constexpr int32_t NO_TEXCOORD = INT32_MIN;
+
+    int32_t v;      // 0 based absolute, or chunk relative when vRelative
+    int32_t vt;     // same for texcoords, NO_TEXCOORD if absent
+    uint8_t vRelative  : 1;
+    uint8_t vtRelative : 1;
+};
+
+struct ObjChunk {
+    std::vector<float>     positions;   // xyz
+    std::vector<float>     colors;      // rgb, one per position
+    std::vector<float>     texCoords;   // uv
+    std::vector<ObjCorner> corners;     // three per triangle
+};
+
+inline const char* SkipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* SkipLine(const char* p, const char* end) {
+    while (p < end && *p != '\n') {
+        ++p;
+    }
+    return p < end ? p + 1 : end;
+}
+
+inline const char* ParseFloat(const char* p, const char* end, float& out) {
+    p = SkipSpaces(p, end);
+    if (p < end && *p == '+') {
+        ++p;
+    }
+
+    auto res = std::from_chars(p, end, out);
+    if (res.ec != std::errc()) {
+        return nullptr;
+    }
+    return res.ptr;
+}
+
+inline const char* ParseInt(const char* p, const char* end, int32_t& out) {
+    auto res = std::from_chars(p, end, out);
+    if (res.ec != std::errc()) {
+        return nullptr;
+    }
+    return res.ptr;
+}
+
+void ParseObjChunk(const char* p, const char* end, ObjChunk& chunk) {
+    std::vector<ObjCorner> polygon;
+
+    int32_t localPositions = 0;
+    int32_t localTexCoords = 0;
+
+    while (p < end) {
+        p = SkipSpaces(p, end);
+        if (p >= end) {
+            break;
+        }
+
+        if (p[0] == 'v' && p + 1 < end && (p[1] == ' ' || p[1] == '\t')) {
+            float xyz[3];
+            float rgb[3] = { 1.0f, 1.0f, 1.0f };
+
+            const char* q = p + 1;
+            for (float& f : xyz) {
+                q = q ? ParseFloat(q, end, f) : nullptr;
+            }
+
+            if (!q) {
+                throw std::runtime_error("Malformed OBJ vertex position!");
+            }
+
+            // optional per vertex colour
+            const char* c = SkipSpaces(q, end);
+            if (c < end && *c != '\n' && *c != '\r') {
+                float tmp[3];
+                const char* r = c;
+                for (float& f : tmp) {
+                    r = r ? ParseFloat(r, end, f) : nullptr;
+                }
+                if (r) {
+                    std::copy(std::begin(tmp), std::end(tmp), std::begin(rgb));
+                }
+            }
+
+            chunk.positions.insert(chunk.positions.end(), std::begin(xyz), std::end(xyz));
+            chunk.colors.insert(chunk.colors.end(), std::begin(rgb), std::end(rgb));
+            localPositions++;
+        }
+        else if (p[0] == 'v' && p + 2 < end && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+            float uv[2];
+
+            const char* q = p + 2;
+            for (float& f : uv) {
+                q = q ? ParseFloat(q, end, f) : nullptr;
+            }
+
+            if (!q) {
+                throw std::runtime_error("Malformed OBJ texture coordinate!");
+            }
+
+            // OBJ has its uv origin bottom left, vulkan samples from top left
+            chunk.texCoords.push_back(uv[0]);
+            chunk.texCoords.push_back(1.0f - uv[1]);
+            localTexCoords++;
+        }
+        else if (p[0] == 'f' && p + 1 < end && (p[1] == ' ' || p[1] == '\t')) {
+            polygon.clear();
+
+            const char* q = p + 1;
+            for (;;) {
+                q = SkipSpaces(q, end);
+                if (q >= end || *q == '\n' || *q == '\r' || *q == '#') {
+                    break;
+                }
+
+                ObjCorner corner{ 0, ObjCorner::NO_TEXCOORD, 0, 0 };
+                int32_t   idx = 0;
+
+                q = ParseInt(q, end, idx);
+                if (!q || idx == 0) {
+                    throw std::runtime_error("Malformed OBJ face!");
+                }
+
+                if (idx < 0) {
+                    corner.v = localPositions + idx;
+                    corner.vRelative = 1;
+                }
+                else {
+                    corner.v = idx - 1;
+                }
+
+                if (q < end && *q == '/') {
+                    ++q;
+                    if (q < end && *q != '/') {
+                        q = ParseInt(q, end, idx);
+                        if (!q || idx == 0) {
+                            throw std::runtime_error("Malformed OBJ face!");
+                        }
+
+                        if (idx < 0) {
+                            corner.vt = localTexCoords + idx;
+                            corner.vtRelative = 1;
+                        }
+                        else {
+                            corner.vt = idx - 1;
+                        }
+                    }
+
+                    // normal index is not part of our vertex, skip it
+                    if (q < end && *q == '/') {
+                        ++q;
+                        while (q < end && (*q == '-' || (*q >= '0' && *q <= '9'))) {
+                            ++q;
+                        }
+                    }
+                }
+
+                polygon.push_back(corner);
+            }
+
+            // fan triangulation
+            for (size_t i = 2; i < polygon.size(); ++i) {
+                chunk.corners.push_back(polygon[0]);
+                chunk.corners.push_back(polygon[i - 1]);
+                chunk.corners.push_back(polygon[i]);
+            }
+        }
+
+        p = SkipLine(p, end);
+    }
+}
+
+}
+
+MeshData MeshLoader::LoadObj(const std::string& path) {
+    MappedFile file(path);
+
+    const char* begin = reinterpret_cast<const char*>(file.Data());
+    const char* end   = begin + file.Size();
+
+    // chunk boundaries snapped forward to the next line start
+    constexpr size_t minChunkBytes = 1 << 20;
+
+    size_t hw         = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t chunkCount = std::clamp<size_t>(file.Size() / minChunkBytes, 1, hw);
+
+    std::vector<const char*> bounds(chunkCount + 1);
+    bounds[0]          = begin;
+    bounds[chunkCount] = end;
+
+    for (size_t i = 1; i < chunkCount; ++i) {
+        const char* p = begin + (file.Size() * i) / chunkCount;
+        p = std::max(p, bounds[i - 1]);
+        while (p < end && p[-1] != '\n') {
+            ++p;
+        }
+        bounds[i] = p;
+    }
+
+    std::vector<ObjChunk> chunks(chunkCount);
+
+    ParallelFor(chunkCount, 1, [&](size_t first, size_t last, size_t) {
+        for (size_t i = first; i < last; ++i) {
+            ParseObjChunk(bounds[i], bounds[i + 1], chunks[i]);
+        }
+    });
+
+    // stitch chunks, relative indices become absolute once the prefix counts are known
+    std::vector<int64_t> positionBase(chunkCount + 1, 0);
+    std::vector<int64_t> texCoordBase(chunkCount + 1, 0);
+    size_t               cornerCount = 0;
+
+    for (size_t i = 0; i < chunkCount; ++i) {
+        positionBase[i + 1] = positionBase[i] + chunks[i].positions.size() / 3;
+        texCoordBase[i + 1] = texCoordBase[i] + chunks[i].texCoords.size() / 2;
+        cornerCount        += chunks[i].corners.size();
+    }
+
+    const int64_t totalPositions = positionBase[chunkCount];
+    const int64_t totalTexCoords = texCoordBase[chunkCount];
+
+    std::vector<float> positions(static_cast<size_t>(totalPositions) * 3);
+    std::vector<float> colors(static_cast<size_t>(totalPositions) * 3);
+    std::vector<float> texCoords(static_cast<size_t>(totalTexCoords) * 2);
+
+    for (size_t i = 0; i < chunkCount; ++i) {
+        std::copy(chunks[i].positions.begin(), chunks[i].positions.end(), positions.begin() + positionBase[i] * 3);
+        std::copy(chunks[i].colors.begin(),    chunks[i].colors.end(),    colors.begin()    + positionBase[i] * 3);
+        std::copy(chunks[i].texCoords.begin(), chunks[i].texCoords.end(), texCoords.begin() + texCoordBase[i] * 2);
+
+        chunks[i].positions = {};
+        chunks[i].colors    = {};
+        chunks[i].texCoords = {};
+    }
+
+    // dedup on the (position, texcoord) pair
+    MeshData mesh;
+    mesh.indices.reserve(cornerCount);
+
+    FlatIndexMap<uint64_t, U64Hash, U64Equal> remap(cornerCount / 4);
+
+    for (size_t c = 0; c < chunkCount; ++c) {
+        for (const ObjCorner& corner : chunks[c].corners) {
+            int64_t v  = corner.vRelative ? positionBase[c] + corner.v : corner.v;
+            int64_t vt = -1;
+
+            if (corner.vt != ObjCorner::NO_TEXCOORD) {
+                vt = corner.vtRelative ? texCoordBase[c] + corner.vt : corner.vt;
+                if (vt < 0 || vt >= totalTexCoords) {
+                    throw std::runtime_error("OBJ texture coordinate index out of range!");
+                }
+            }
+
+            if (v < 0 || v >= totalPositions) {
+                throw std::runtime_error("OBJ position index out of range!");
+            }
+
+            uint64_t key   = (static_cast<uint64_t>(v) << 32) | static_cast<uint32_t>(vt + 1);
+            uint32_t next  = static_cast<uint32_t>(mesh.vertices.size());
+            uint32_t index = remap.FindOrInsert(key, next);
+
+            if (index == next) {
+                Vertex vert{};
+                std::memcpy(vert.position, &positions[v * 3], sizeof(vert.position));
+                std::memcpy(vert.color,    &colors[v * 3],    sizeof(vert.color));
+                if (vt >= 0) {
+                    std::memcpy(vert.texCoord, &texCoords[vt * 2], sizeof(vert.texCoord));
+                }
+                mesh.vertices.push_back(vert);
+            }
+
+            mesh.indices.push_back(index);
+        }
+    }
+
+    return mesh;
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region glTF
+
+namespace {
+
+// just enough JSON for glTF documents
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type                                            type    = Type::Null;
+    bool                                            boolean = false;
+    double                                          number  = 0.0;
+    std::string                                     str;
+    std::vector<JsonValue>                          array;
+    std::vector<std::pair<std::string, JsonValue>>  object;
+
+    const JsonValue* Find(const char* key) const {
+        for (auto& kv : object) {
+            if (kv.first == key) {
+                return &kv.second;
+            }
+        }
+        return nullptr;
+    }
+
+    double NumberOr(const char* key, double fallback) const {
+        auto v = Find(key);
+        return (v && v->type == Type::Number) ? v->number : fallback;
+    }
+
+    size_t Size() const { return array.size(); }
+
+    const JsonValue& operator[](size_t i) const {
+        if (i >= array.size()) {
+            throw std::runtime_error("glTF: array index out of range");
+        }
+        return array[i];
+    }
+};
+
+class JsonParser {
+public:
+    JsonParser(const char* begin, const char* end) : p(begin), end(end) {}
+
+    JsonValue Parse() {
+        JsonValue v = ParseValue();
+        SkipWhitespace();
+        return v;
+    }
+
+private:
+    void SkipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            ++p;
+        }
+    }
+
+    void Expect(char c) {
+        SkipWhitespace();
+        if (p >= end || *p != c) {
+            throw std::runtime_error("Malformed glTF JSON!");
+        }
+        ++p;
+    }
+
+    bool Consume(const char* literal) {
+        size_t len = std::strlen(literal);
+        if (static_cast<size_t>(end - p) >= len && std::memcmp(p, literal, len) == 0) {
+            p += len;
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue ParseValue() {
+        SkipWhitespace();
+        if (p >= end) {
+            throw std::runtime_error("Unexpected end of glTF JSON!");
+        }
+
+        JsonValue v;
+
+        switch (*p) {
+        case '{':
+            v.type = JsonValue::Type::Object;
+            ++p;
+            SkipWhitespace();
+            if (p < end && *p == '}') {
+                ++p;
+                break;
+            }
+            for (;;) {
+                SkipWhitespace();
+                std::string key = ParseString();
+                Expect(':');
+                v.object.emplace_back(std::move(key), ParseValue());
+                SkipWhitespace();
+                if (p < end && *p == ',') {
+                    ++p;
+                    continue;
+                }
+                Expect('}');
+                break;
+            }
+            break;
+
+        case '[':
+            v.type = JsonValue::Type::Array;
+            ++p;
+            SkipWhitespace();
+            if (p < end && *p == ']') {
+                ++p;
+                break;
+            }
+            for (;;) {
+                v.array.push_back(ParseValue());
+                SkipWhitespace();
+                if (p < end && *p == ',') {
+                    ++p;
+                    continue;
+                }
+                Expect(']');
+                break;
+            }
+            break;
+
+        case '"':
+            v.type = JsonValue::Type::String;
+            v.str  = ParseString();
+            break;
+
+        default:
+            if (Consume("true")) {
+                v.type = JsonValue::Type::Bool;
+                v.boolean = true;
+            }
+            else if (Consume("false")) {
+                v.type = JsonValue::Type::Bool;
+            }
+            else if (Consume("null")) {
+                v.type = JsonValue::Type::Null;
+            }
+            else {
+                v.type = JsonValue::Type::Number;
+                if (*p == '+') {
+                    ++p;
+                }
+                auto res = std::from_chars(p, end, v.number);
+                if (res.ec != std::errc()) {
+                    throw std::runtime_error("Malformed number in glTF JSON!");
+                }
+                p = res.ptr;
+            }
+            break;
+        }
+
+        return v;
+    }
+
+    std::string ParseString() {
+        if (p >= end || *p != '"') {
+            throw std::runtime_error("Expected string in glTF JSON!");
+        }
+        ++p;
+
+        std::string out;
+        while (p < end && *p != '"') {
+            if (*p == '\\' && p + 1 < end) {
+                ++p;
+                switch (*p) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    // names & uris only, keep non ascii escapes verbatim
+                    out += "\\u";
+                    break;
+                default:  out += *p; break;
+                }
+                ++p;
+            }
+            else {
+                out += *p++;
+            }
+        }
+
+        if (p >= end) {
+            throw std::runtime_error("Unterminated string in glTF JSON!");
+        }
+        ++p;
+
+        return out;
+    }
+
+    const char* p;
+    const char* end;
+};
+
+struct GltfAccessor {
+    const uint8_t* data       = nullptr;
+    size_t         count      = 0;
+    size_t         stride     = 0;
+    uint32_t       components = 0;
+    uint32_t       componentType = 0;
+    bool           normalized = false;
+
+    float ReadFloat(size_t i, uint32_t c) const {
+        const uint8_t* e = data + i * stride;
+
+        switch (componentType) {
+        case 5126: { float    f; std::memcpy(&f, e + c * 4, 4); return f; }
+        case 5121: { uint8_t  u = e[c];                                 return normalized ? u / 255.0f   : float(u); }
+        case 5120: { int8_t   s = static_cast<int8_t>(e[c]);            return normalized ? std::max(s / 127.0f, -1.0f)   : float(s); }
+        case 5123: { uint16_t u; std::memcpy(&u, e + c * 2, 2); return normalized ? u / 65535.0f : float(u); }
+        case 5122: { int16_t  s; std::memcpy(&s, e + c * 2, 2); return normalized ? std::max(s / 32767.0f, -1.0f) : float(s); }
+        case 5125: { uint32_t u; std::memcpy(&u, e + c * 4, 4); return float(u); }
+        }
+
+        throw std::runtime_error("Unsupported glTF component type!");
+    }
+
+    uint32_t ReadIndex(size_t i) const {
+        const uint8_t* e = data + i * stride;
+
+        switch (componentType) {
+        case 5121: return e[0];
+        case 5123: { uint16_t u; std::memcpy(&u, e, 2); return u; }
+        case 5125: { uint32_t u; std::memcpy(&u, e, 4); return u; }
+        }
+
+        throw std::runtime_error("Unsupported glTF index type!");
+    }
+};
+
+// an index into one of the document's arrays, count long; kind names it in the error
+size_t GltfIndex(const JsonValue* index, size_t count, const char* kind) {
+    if (!index || index->type != JsonValue::Type::Number || !(index->number >= 0.0) || index->number >= double(count)) {
+        throw std::runtime_error(std::string("glTF: ") + kind + " index out of range");
+    }
+    return static_cast<size_t>(index->number);
+}
+
+// a byte offset, length or element count; negative or absurd values would wrap in size_t
+size_t GltfSize(const JsonValue& object, const char* key) {
+    const double value = object.NumberOr(key, 0);
+    if (!(value >= 0.0) || value > double(1ull << 48)) {
+        throw std::runtime_error(std::string("glTF: ") + key + " out of range");
+    }
+    return static_cast<size_t>(value);
+}
+
+struct GltfDocument {
+    JsonValue                         json;
+    std::vector<MappedFile>           files;
+    std::vector<std::pair<const uint8_t*, size_t>> buffers;
+
+    GltfAccessor Accessor(const JsonValue& index) const {
+        const JsonValue* accessors = json.Find("accessors");
+        const JsonValue& acc       = (*accessors)[GltfIndex(&index, accessors->Size(), "accessor")];
+
+        static const std::pair<const char*, uint32_t> typeTable[] = {
+            { "SCALAR", 1 }, { "VEC2", 2 }, { "VEC3", 3 }, { "VEC4", 4 }
+        };
+
+        GltfAccessor out;
+        out.count         = GltfSize(acc, "count");
+        out.componentType = static_cast<uint32_t>(acc.NumberOr("componentType", 0));
+
+        if (auto n = acc.Find("normalized")) {
+            out.normalized = n->boolean;
+        }
+
+        if (auto t = acc.Find("type")) {
+            for (auto& entry : typeTable) {
+                if (t->str == entry.first) {
+                    out.components = entry.second;
+                }
+            }
+        }
+
+        if (!out.components) {
+            throw std::runtime_error("Unsupported glTF accessor type!");
+        }
+
+        if (acc.Find("sparse")) {
+            throw std::runtime_error("Sparse glTF accessors are not supported!");
+        }
+
+        auto viewIndex = acc.Find("bufferView");
+        if (!viewIndex) {
+            throw std::runtime_error("glTF accessor without bufferView is not supported!");
+        }
+
+        const JsonValue* views = json.Find("bufferViews");
+        const JsonValue& view  = (*views)[GltfIndex(viewIndex, views->Size(), "bufferView")];
+
+        size_t buffer     = GltfIndex(view.Find("buffer"), buffers.size(), "buffer");
+        size_t viewOffset = GltfSize(view, "byteOffset");
+        size_t viewLength = GltfSize(view, "byteLength");
+        size_t accOffset  = GltfSize(acc, "byteOffset");
+
+        uint32_t componentSize = (out.componentType == 5126 || out.componentType == 5125) ? 4 :
+                                 (out.componentType == 5122 || out.componentType == 5123) ? 2 : 1;
+
+        out.stride = GltfSize(view, "byteStride");
+        if (!out.stride) {
+            out.stride = componentSize * out.components;
+        }
+
+        // the last element ends inside the view, the view inside the buffer; compared by
+        // subtraction, so a large count can not wrap the span around
+        const auto&  buf         = buffers[buffer];
+        const size_t elementSize = componentSize * out.components;
+
+        if (viewOffset > buf.second || viewLength > buf.second - viewOffset || accOffset > viewLength) {
+            throw std::runtime_error("glTF accessor exceeds its buffer!");
+        }
+
+        if (out.count && (elementSize > viewLength - accOffset || out.count - 1 > (viewLength - accOffset - elementSize) / out.stride)) {
+            throw std::runtime_error("glTF accessor exceeds its buffer!");
+        }
+
+        size_t offset = viewOffset + accOffset;
+        out.data = buf.first + offset;
+        return out;
+    }
+};
+
+glm::mat4 GltfNodeMatrix(const JsonValue& node) {
+    if (auto m = node.Find("matrix")) {
+        glm::mat4 mat(1.0f);
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                mat[c][r] = static_cast<float>((*m)[c * 4 + r].number);
+            }
+        }
+        return mat;
+    }
+
+    glm::vec3 t(0.0f), s(1.0f);
+    glm::quat q(1.0f, 0.0f, 0.0f, 0.0f);
+
+    if (auto v = node.Find("translation")) {
+        t = glm::vec3(float((*v)[0].number), float((*v)[1].number), float((*v)[2].number));
+    }
+
+    if (auto v = node.Find("rotation")) {
+        // glTF stores x, y, z, w
+        q = glm::quat(float((*v)[3].number), float((*v)[0].number), float((*v)[1].number), float((*v)[2].number));
+    }
+
+    if (auto v = node.Find("scale")) {
+        s = glm::vec3(float((*v)[0].number), float((*v)[1].number), float((*v)[2].number));
+    }
+
+    return glm::translate(glm::mat4(1.0f), t) * glm::mat4_cast(q) * glm::scale(glm::mat4(1.0f), s);
+}
+
+void AppendGltfMesh(const GltfDocument& doc, size_t meshIndex, const glm::mat4& world, MeshData& mesh) {
+    const JsonValue& gltfMesh = (*doc.json.Find("meshes"))[meshIndex];
+    const JsonValue* primitives = gltfMesh.Find("primitives");
+    if (!primitives) {
+        return;
+    }
+
+    for (const JsonValue& prim : primitives->array) {
+        // triangles only
+        if (prim.NumberOr("mode", 4) != 4) {
+            continue;
+        }
+
+        const JsonValue* attributes = prim.Find("attributes");
+        const JsonValue* position   = attributes ? attributes->Find("POSITION") : nullptr;
+        if (!position) {
+            continue;
+        }
+
+        GltfAccessor positions = doc.Accessor(*position);
+
+        GltfAccessor texCoords, colors;
+        if (auto a = attributes->Find("TEXCOORD_0")) {
+            texCoords = doc.Accessor(*a);
+        }
+        if (auto a = attributes->Find("COLOR_0")) {
+            colors = doc.Accessor(*a);
+        }
+
+        // every component read below lies inside the checked element
+        if (positions.components < 3 || (texCoords.data && texCoords.components < 2) || (colors.data && colors.components < 3)) {
+            throw std::runtime_error("glTF: attribute has too few components");
+        }
+
+        size_t   count = positions.count;
+        uint32_t base  = static_cast<uint32_t>(mesh.vertices.size());
+
+        mesh.vertices.resize(mesh.vertices.size() + count);
+
+        ParallelFor(count, 1 << 16, [&](size_t first, size_t last, size_t) {
+            for (size_t i = first; i < last; ++i) {
+                Vertex& v = mesh.vertices[base + i];
+
+                glm::vec4 p = world * glm::vec4(positions.ReadFloat(i, 0), positions.ReadFloat(i, 1), positions.ReadFloat(i, 2), 1.0f);
+                v.position[0] = p.x;
+                v.position[1] = p.y;
+                v.position[2] = p.z;
+
+                for (uint32_t c = 0; c < 3; ++c) {
+                    v.color[c] = (colors.data && i < colors.count) ? colors.ReadFloat(i, c) : 1.0f;
+                }
+
+                for (uint32_t c = 0; c < 2; ++c) {
+                    v.texCoord[c] = (texCoords.data && i < texCoords.count) ? texCoords.ReadFloat(i, c) : 0.0f;
+                }
+            }
+        });
+
+        if (auto idx = prim.Find("indices")) {
+            GltfAccessor indices = doc.Accessor(*idx);
+            size_t first = mesh.indices.size();
+
+            mesh.indices.resize(first + indices.count);
+
+            ParallelFor(indices.count, 1 << 18, [&](size_t b, size_t e, size_t) {
+                for (size_t i = b; i < e; ++i) {
+                    uint32_t index = indices.ReadIndex(i);
+                    if (index >= count) {
+                        throw std::runtime_error("glTF index out of range!");
+                    }
+                    mesh.indices[first + i] = base + index;
+                }
+            });
+        }
+        else {
+            for (uint32_t i = 0; i < count; ++i) {
+                mesh.indices.push_back(base + i);
+            }
+        }
+    }
+}
+
+}
+
+MeshData MeshLoader::LoadGltf(const std::string& path) {
+    GltfDocument doc;
+    MappedFile   file(path);
+
+    const uint8_t* glbBin     = nullptr;
+    size_t         glbBinSize = 0;
+
+    const char* jsonBegin = reinterpret_cast<const char*>(file.Data());
+    const char* jsonEnd   = jsonBegin + file.Size();
+
+    // binary container: 12 byte header, then JSON & BIN chunks
+    if (file.Size() >= 12 && std::memcmp(file.Data(), "glTF", 4) == 0) {
+        size_t offset = 12;
+
+        while (offset + 8 <= file.Size()) {
+            uint32_t chunkLength, chunkType;
+            std::memcpy(&chunkLength, file.Data() + offset, 4);
+            std::memcpy(&chunkType,   file.Data() + offset + 4, 4);
+
+            const uint8_t* chunkData = file.Data() + offset + 8;
+            if (offset + 8 + chunkLength > file.Size()) {
+                throw std::runtime_error("Truncated glb chunk!");
+            }
+
+            if (chunkType == 0x4E4F534A) {          // JSON
+                jsonBegin = reinterpret_cast<const char*>(chunkData);
+                jsonEnd   = jsonBegin + chunkLength;
+            }
+            else if (chunkType == 0x004E4942) {     // BIN
+                glbBin     = chunkData;
+                glbBinSize = chunkLength;
+            }
+
+            offset += 8 + ((chunkLength + 3) & ~3u);
+        }
+    }
+
+    doc.json = JsonParser(jsonBegin, jsonEnd).Parse();
+
+    if (!doc.json.Find("meshes") || !doc.json.Find("accessors") || !doc.json.Find("bufferViews")) {
+        throw std::runtime_error("glTF file has no mesh data: " + path);
+    }
+
+    if (auto buffers = doc.json.Find("buffers")) {
+        doc.files.reserve(buffers->Size());
+
+        for (const JsonValue& buf : buffers->array) {
+            auto uri = buf.Find("uri");
+            if (!uri) {
+                doc.buffers.emplace_back(glbBin, glbBinSize);
+                continue;
+            }
+
+            if (uri->str.compare(0, 5, "data:") == 0) {
+                throw std::runtime_error("Embedded base64 glTF buffers are not supported, use .bin or .glb!");
+            }
+
+            doc.files.emplace_back(DirectoryOf(path) + uri->str);
+            doc.buffers.emplace_back(doc.files.back().Data(), doc.files.back().Size());
+        }
+    }
+
+    MeshData raw;
+
+    // walk the default scene so node transforms are baked, fall back to every mesh as is
+    const JsonValue* scenes = doc.json.Find("scenes");
+    const JsonValue* nodes  = doc.json.Find("nodes");
+
+    if (scenes && nodes && scenes->Size()) {
+        const JsonValue* sceneIndex = doc.json.Find("scene");
+        const JsonValue& scene      = (*scenes)[sceneIndex ? GltfIndex(sceneIndex, scenes->Size(), "scene") : 0];
+
+        const size_t meshCount = doc.json.Find("meshes")->Size();
+
+        std::vector<std::pair<size_t, glm::mat4>> stack;
+        if (auto roots = scene.Find("nodes")) {
+            for (auto& r : roots->array) {
+                stack.emplace_back(GltfIndex(&r, nodes->Size(), "node"), glm::mat4(1.0f));
+            }
+        }
+
+        // nodes form trees, one reached twice means the file lists a cycle (or a shared child)
+        std::vector<bool> visited(nodes->Size());
+
+        while (!stack.empty()) {
+            auto [nodeIndex, parentMatrix] = stack.back();
+            stack.pop_back();
+
+            if (visited[nodeIndex]) {
+                throw std::runtime_error("glTF: node hierarchy has a cycle");
+            }
+            visited[nodeIndex] = true;
+
+            const JsonValue& node = (*nodes)[nodeIndex];
+            glm::mat4 world = parentMatrix * GltfNodeMatrix(node);
+
+            if (auto m = node.Find("mesh")) {
+                AppendGltfMesh(doc, GltfIndex(m, meshCount, "mesh"), world, raw);
+            }
+
+            if (auto children = node.Find("children")) {
+                for (auto& c : children->array) {
+                    stack.emplace_back(GltfIndex(&c, nodes->Size(), "node"), world);
+                }
+            }
+        }
+    }
+    else {
+        for (size_t m = 0; m < doc.json.Find("meshes")->Size(); ++m) {
+            AppendGltfMesh(doc, m, glm::mat4(1.0f), raw);
+        }
+    }
+
+    // primitives & instanced nodes commonly repeat identical vertices, merge them
+    MeshData mesh;
+    mesh.indices.resize(raw.indices.size());
+    mesh.vertices.reserve(raw.vertices.size());
+
+    std::vector<uint32_t> remapTable(raw.vertices.size());
+    FlatIndexMap<Vertex, VertexHash, VertexEqual> remap(raw.vertices.size());
+
+    for (size_t i = 0; i < raw.vertices.size(); ++i) {
+        uint32_t next  = static_cast<uint32_t>(mesh.vertices.size());
+        uint32_t index = remap.FindOrInsert(raw.vertices[i], next);
+        if (index == next) {
+            mesh.vertices.push_back(raw.vertices[i]);
+        }
+        remapTable[i] = index;
+    }
+
+    for (size_t i = 0; i < raw.indices.size(); ++i) {
+        mesh.indices[i] = remapTable[raw.indices[i]];
+    }
+
+    return mesh;
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+MeshData MeshLoader::Load(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+
+    MeshData mesh;
+    std::string ext = LowerExtension(path);
+
+    if (ext == "obj") {
+        mesh = LoadObj(path);
+    }
+    else if (ext == "gltf" || ext == "glb") {
+        mesh = LoadGltf(path);
+    }
+    else {
+        throw std::runtime_error("Unsupported mesh format: " + path);
+    }
+
+    if (mesh.indices.empty()) {
+        throw std::runtime_error("Mesh has no triangles: " + path);
+    }
+
+    mesh.ComputeBounds();
+
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Loaded " << path << ": " << mesh.vertices.size() << " vertices, "
+              << mesh.indices.size() / 3 << " triangles in " << ms << " ms" << std::endl;
+
+    return mesh;
+}
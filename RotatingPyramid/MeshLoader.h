@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Vertex.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// CPU side mesh, already in the interleaved Vertex layout the pipeline consumes.
+// Indices are kept 32 bit here; the GPU index type is picked from the vertex count.
+struct MeshData {
+    std::vector<Vertex>   vertices;
+    std::vector<uint32_t> indices;
+
+    float                 boundsMin[3] = {  0.0f,  0.0f,  0.0f };
+    float                 boundsMax[3] = {  0.0f,  0.0f,  0.0f };
+
+    uint32_t     IndexCount() const { return static_cast<uint32_t>(indices.size()); }
+
+    // 16 bit indices whenever every vertex is addressable with them
+    VkIndexType  IndexType() const { return vertices.size() <= 0x10000 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32; }
+    VkDeviceSize IndexBufferSize() const;
+    VkDeviceSize VertexBufferSize() const { return vertices.size() * sizeof(Vertex); }
+
+    // writes indices narrowed to IndexType(), dst must hold IndexBufferSize() bytes
+    void WriteIndices(void* dst) const;
+
+    void ComputeBounds();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Loads Wavefront OBJ (with the common "v x y z r g b" colour extension) and glTF 2.0
+// (.gltf + external .bin, or .glb). Files are memory mapped and parsed on all cores;
+// identical vertices are merged through an open addressing hash map.
+class MeshLoader {
+public:
+    // picks the parser from the file extension
+    static MeshData Load(const std::string& path);
+
+    static MeshData LoadObj(const std::string& path);
+    static MeshData LoadGltf(const std::string& path);
+};
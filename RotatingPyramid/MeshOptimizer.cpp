@@ -0,0 +1,523 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region Optimize
+
+MeshOptimizer::Report MeshOptimizer::Optimize(MeshData& mesh, uint32_t cacheSize, float overdrawThreshold) {
+    Report report;
+
+    uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+
+    report.cacheBefore    = AnalyzeVertexCache(mesh.indices, vertexCount, cacheSize);
+    report.fetchBefore    = AnalyzeVertexFetch(mesh.indices, vertexCount, sizeof(Vertex));
+    report.overdrawBefore = AnalyzeOverdraw(mesh.indices, mesh.vertices);
+
+    std::vector<uint32_t> hardClusters;
+
+    mesh.indices = OptimizeVertexCache(mesh.indices, vertexCount, cacheSize, &hardClusters);
+    mesh.indices = OptimizeOverdraw(mesh.indices, mesh.vertices, hardClusters, cacheSize, overdrawThreshold);
+    vertexCount  = OptimizeVertexFetch(mesh.vertices, mesh.indices);
+
+    report.cacheAfter    = AnalyzeVertexCache(mesh.indices, vertexCount, cacheSize);
+    report.fetchAfter    = AnalyzeVertexFetch(mesh.indices, vertexCount, sizeof(Vertex));
+    report.overdrawAfter = AnalyzeOverdraw(mesh.indices, mesh.vertices);
+
+    return report;
+}
+
+void MeshOptimizer::PrintReport(const Report& r) {
+    std::cout << std::fixed << std::setprecision(3)
+              << "Mesh optimizer: ACMR "    << r.cacheBefore.acmr         << " -> " << r.cacheAfter.acmr
+              << ", ATVR "                  << r.cacheBefore.atvr         << " -> " << r.cacheAfter.atvr
+              << ", overfetch "             << r.fetchBefore.overfetch    << " -> " << r.fetchAfter.overfetch
+              << ", overdraw "              << r.overdrawBefore.overdraw  << " -> " << r.overdrawAfter.overdraw
+              << std::defaultfloat << std::endl;
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region Vertex cache
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount,
+                                                          uint32_t cacheSize, std::vector<uint32_t>* clusterStarts) {
+    const uint32_t triCount = static_cast<uint32_t>(indices.size() / 3);
+
+    // vertex -> triangle adjacency in CSR form
+    std::vector<uint32_t> adjOffset(vertexCount + 1, 0);
+    for (uint32_t idx : indices) {
+        adjOffset[idx + 1]++;
+    }
+
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        adjOffset[v + 1] += adjOffset[v];
+    }
+
+    std::vector<uint32_t> adjTris(indices.size());
+    {
+        std::vector<uint32_t> cursor(adjOffset.begin(), adjOffset.end() - 1);
+        for (uint32_t t = 0; t < triCount; ++t) {
+            for (uint32_t c = 0; c < 3; ++c) {
+                adjTris[cursor[indices[t * 3 + c]]++] = t;
+            }
+        }
+    }
+
+    std::vector<uint32_t> liveTris(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        liveTris[v] = adjOffset[v + 1] - adjOffset[v];
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<uint8_t>  emitted(triCount, 0);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+
+    result.reserve(indices.size());
+    deadEnd.reserve(indices.size());
+
+    uint32_t time   = cacheSize + 1;
+    uint32_t cursor = 0;            // next vertex to try when the dead end stack runs dry
+    int64_t  fan    = 0;
+
+    if (clusterStarts) {
+        clusterStarts->clear();
+        clusterStarts->push_back(0);
+    }
+
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEnd.empty()) {
+            uint32_t d = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTris[d] > 0) {
+                return d;
+            }
+        }
+
+        while (cursor < vertexCount) {
+            if (liveTris[cursor] > 0) {
+                return cursor;
+            }
+            ++cursor;
+        }
+
+        return -1;
+    };
+
+    // skip leading unreferenced vertices
+    fan = vertexCount ? skipDeadEnd() : -1;
+
+    while (fan >= 0) {
+        candidates.clear();
+
+        for (uint32_t a = adjOffset[fan]; a < adjOffset[fan + 1]; ++a) {
+            uint32_t t = adjTris[a];
+            if (emitted[t]) {
+                continue;
+            }
+
+            for (uint32_t c = 0; c < 3; ++c) {
+                uint32_t v = indices[t * 3 + c];
+
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+
+                liveTris[v]--;
+
+                if (time - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = time++;
+                }
+            }
+
+            emitted[t] = 1;
+        }
+
+        // best next fanning vertex: still in cache after its remaining triangles are emitted
+        int64_t  next     = -1;
+        int64_t  bestPrio = -1;
+
+        for (uint32_t v : candidates) {
+            if (liveTris[v] == 0) {
+                continue;
+            }
+
+            int64_t prio = 0;
+            if (int64_t(time) - int64_t(cacheTime[v]) + 2 * int64_t(liveTris[v]) <= int64_t(cacheSize)) {
+                prio = int64_t(time) - int64_t(cacheTime[v]);
+            }
+
+            if (prio > bestPrio) {
+                bestPrio = prio;
+                next     = v;
+            }
+        }
+
+        if (next < 0) {
+            next = skipDeadEnd();
+
+            if (next >= 0 && clusterStarts && result.size() / 3 < triCount) {
+                clusterStarts->push_back(static_cast<uint32_t>(result.size() / 3));
+            }
+        }
+
+        fan = next;
+    }
+
+    return result;
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize) {
+    CacheStats stats;
+
+    if (indices.empty()) {
+        return stats;
+    }
+
+    // FIFO: a vertex stays resident for cacheSize subsequent misses
+    constexpr uint32_t NEVER = UINT32_MAX;
+
+    std::vector<uint32_t> insertedAt(vertexCount, NEVER);
+    std::vector<uint8_t>  referenced(vertexCount, 0);
+
+    uint32_t misses = 0;
+    uint32_t unique = 0;
+
+    for (uint32_t v : indices) {
+        if (!referenced[v]) {
+            referenced[v] = 1;
+            unique++;
+        }
+
+        if (insertedAt[v] == NEVER || misses - insertedAt[v] >= cacheSize) {
+            insertedAt[v] = misses++;
+        }
+    }
+
+    stats.acmr = float(misses) / float(indices.size() / 3);
+    stats.atvr = float(misses) / float(std::max(1u, unique));
+
+    return stats;
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region Overdraw
+
+std::vector<uint32_t> MeshOptimizer::OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                                                      const std::vector<uint32_t>& hardClusters, uint32_t cacheSize, float threshold) {
+    const uint32_t triCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triCount == 0) {
+        return indices;
+    }
+
+    // ACMR of the triangle range [first, last) when simulated from an empty cache
+    std::vector<uint32_t> insertedAt(vertices.size(), UINT32_MAX);
+    uint32_t              misses = 0;
+
+    auto flush = [&]() {
+        // moving the clock far ahead evicts everything without touching the array
+        misses += cacheSize + 1;
+    };
+
+    auto touch = [&](uint32_t t) -> uint32_t {
+        uint32_t m = 0;
+        for (uint32_t c = 0; c < 3; ++c) {
+            uint32_t v = indices[t * 3 + c];
+            if (insertedAt[v] == UINT32_MAX || misses - insertedAt[v] >= cacheSize) {
+                insertedAt[v] = misses++;
+                m++;
+            }
+        }
+        return m;
+    };
+
+    // soft boundaries: split a hard cluster wherever the running ACMR is already within
+    // threshold of the whole cluster's ACMR, restarting from a cold cache costs little there
+    std::vector<uint32_t> clusters;
+
+    for (size_t h = 0; h < hardClusters.size(); ++h) {
+        uint32_t first = hardClusters[h];
+        uint32_t last  = (h + 1 < hardClusters.size()) ? hardClusters[h + 1] : triCount;
+
+        flush();
+        uint32_t clusterMisses = 0;
+        for (uint32_t t = first; t < last; ++t) {
+            clusterMisses += touch(t);
+        }
+
+        float clusterAcmr = float(clusterMisses) / float(last - first);
+
+        flush();
+        clusters.push_back(first);
+
+        uint32_t runMisses = 0;
+        uint32_t runStart  = first;
+
+        for (uint32_t t = first; t < last; ++t) {
+            runMisses += touch(t);
+
+            uint32_t runTris = t + 1 - runStart;
+            if (t + 1 < last && float(runMisses) / float(runTris) <= threshold * clusterAcmr) {
+                clusters.push_back(t + 1);
+                runStart  = t + 1;
+                runMisses = 0;
+                flush();
+            }
+        }
+    }
+
+    clusters.push_back(triCount);
+
+    // per cluster: area weighted centroid & normal
+    const size_t clusterCount = clusters.size() - 1;
+
+    struct ClusterInfo {
+        uint32_t first, last;
+        float    sortKey;
+    };
+
+    std::vector<ClusterInfo> infos(clusterCount);
+
+    double meshCentroid[3] = { 0.0, 0.0, 0.0 };
+    double meshArea        = 0.0;
+
+    std::vector<float> centroids(clusterCount * 3);
+    std::vector<float> normals(clusterCount * 3);
+
+    for (size_t c = 0; c < clusterCount; ++c) {
+        double centroid[3] = { 0.0, 0.0, 0.0 };
+        double normal[3]   = { 0.0, 0.0, 0.0 };
+        double area        = 0.0;
+
+        for (uint32_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const float* p0 = vertices[indices[t * 3 + 0]].position;
+            const float* p1 = vertices[indices[t * 3 + 1]].position;
+            const float* p2 = vertices[indices[t * 3 + 2]].position;
+
+            double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            double n[3]  = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            double a     = 0.5 * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (int k = 0; k < 3; ++k) {
+                centroid[k] += a * (p0[k] + p1[k] + p2[k]) / 3.0;
+                normal[k]   += n[k];
+            }
+
+            area += a;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            meshCentroid[k] += centroid[k];
+            centroids[c * 3 + k] = area > 0.0 ? float(centroid[k] / area) : 0.0f;
+        }
+
+        double len = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (int k = 0; k < 3; ++k) {
+            normals[c * 3 + k] = len > 0.0 ? float(normal[k] / len) : 0.0f;
+        }
+
+        meshArea += area;
+        infos[c]  = { clusters[c], clusters[c + 1], 0.0f };
+    }
+
+    for (int k = 0; k < 3; ++k) {
+        meshCentroid[k] = meshArea > 0.0 ? meshCentroid[k] / meshArea : 0.0;
+    }
+
+    // clusters facing away from the centre sit on the outside and occlude the rest
+    for (size_t c = 0; c < clusterCount; ++c) {
+        float key = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            key += (centroids[c * 3 + k] - float(meshCentroid[k])) * normals[c * 3 + k];
+        }
+        infos[c].sortKey = key;
+    }
+
+    std::stable_sort(infos.begin(), infos.end(), [](const ClusterInfo& a, const ClusterInfo& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    for (auto& info : infos) {
+        result.insert(result.end(), indices.begin() + info.first * 3, indices.begin() + info.last * 3);
+    }
+
+    return result;
+}
+
+MeshOptimizer::OverdrawStats MeshOptimizer::AnalyzeOverdraw(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices) {
+    // orthographic software raster along +-x, +-y, +-z; back facing triangles are culled
+    // like the pipeline does, so opposite views together see every triangle once
+    constexpr int GRID = 256;
+
+    OverdrawStats stats;
+    if (indices.empty() || vertices.empty()) {
+        return stats;
+    }
+
+    float bmin[3], bmax[3];
+    for (int k = 0; k < 3; ++k) {
+        bmin[k] = std::numeric_limits<float>::max();
+        bmax[k] = std::numeric_limits<float>::lowest();
+    }
+
+    for (auto& v : vertices) {
+        for (int k = 0; k < 3; ++k) {
+            bmin[k] = std::min(bmin[k], v.position[k]);
+            bmax[k] = std::max(bmax[k], v.position[k]);
+        }
+    }
+
+    float extent = std::max({ bmax[0] - bmin[0], bmax[1] - bmin[1], bmax[2] - bmin[2], 1e-12f });
+
+    std::vector<float> depth(GRID * GRID);
+
+    uint64_t shaded  = 0;
+    uint64_t covered = 0;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int dir = -1; dir <= 1; dir += 2) {
+            int ua = (axis + 1) % 3;
+            int va = (axis + 2) % 3;
+
+            std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::max());
+
+            auto project = [&](const float* p, float out[3]) {
+                out[0] = (p[ua] - bmin[ua]) / extent * (GRID - 1);
+                out[1] = (p[va] - bmin[va]) / extent * (GRID - 1);
+                out[2] = dir * p[axis];
+            };
+
+            for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                float a[3], b[3], c[3];
+                project(vertices[indices[t + 0]].position, a);
+                project(vertices[indices[t + 1]].position, b);
+                project(vertices[indices[t + 2]].position, c);
+
+                float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+                if (dir * area <= 0.0f) {
+                    continue;
+                }
+
+                int x0 = std::max(0,        int(std::floor(std::min({ a[0], b[0], c[0] }))));
+                int x1 = std::min(GRID - 1, int(std::ceil (std::max({ a[0], b[0], c[0] }))));
+                int y0 = std::max(0,        int(std::floor(std::min({ a[1], b[1], c[1] }))));
+                int y1 = std::min(GRID - 1, int(std::ceil (std::max({ a[1], b[1], c[1] }))));
+
+                float invArea = 1.0f / area;
+
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = x0; x <= x1; ++x) {
+                        float px = x + 0.5f, py = y + 0.5f;
+
+                        float w0 = ((b[0] - px) * (c[1] - py) - (b[1] - py) * (c[0] - px)) * invArea;
+                        float w1 = ((c[0] - px) * (a[1] - py) - (c[1] - py) * (a[0] - px)) * invArea;
+                        float w2 = 1.0f - w0 - w1;
+
+                        if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                            continue;
+                        }
+
+                        float z = w0 * a[2] + w1 * b[2] + w2 * c[2];
+                        float& d = depth[y * GRID + x];
+
+                        if (z < d) {
+                            d = z;
+                            shaded++;
+                        }
+                    }
+                }
+            }
+
+            for (float d : depth) {
+                covered += d != std::numeric_limits<float>::max();
+            }
+        }
+    }
+
+    stats.overdraw = covered ? float(double(shaded) / double(covered)) : 0.0f;
+    return stats;
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region Vertex fetch
+
+uint32_t MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    constexpr uint32_t UNUSED = UINT32_MAX;
+
+    std::vector<uint32_t> remap(vertices.size(), UNUSED);
+    std::vector<Vertex>   sorted;
+
+    sorted.reserve(vertices.size());
+
+    for (uint32_t& idx : indices) {
+        if (remap[idx] == UNUSED) {
+            remap[idx] = static_cast<uint32_t>(sorted.size());
+            sorted.push_back(vertices[idx]);
+        }
+        idx = remap[idx];
+    }
+
+    vertices.swap(sorted);
+
+    return static_cast<uint32_t>(vertices.size());
+}
+
+MeshOptimizer::FetchStats MeshOptimizer::AnalyzeVertexFetch(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t vertexSize) {
+    // post-transform FIFO in front of a small FIFO of 64 byte lines
+    constexpr uint32_t LINE_SIZE   = 64;
+    constexpr uint32_t LINE_COUNT  = 64;
+    constexpr uint32_t VCACHE_SIZE = DEFAULT_CACHE_SIZE;
+
+    FetchStats stats;
+    if (indices.empty() || vertexCount == 0) {
+        return stats;
+    }
+
+    std::vector<uint32_t> insertedAt(vertexCount, UINT32_MAX);
+    uint32_t              vmisses = 0;
+
+    uint64_t lines[LINE_COUNT];
+    std::fill(std::begin(lines), std::end(lines), UINT64_MAX);
+
+    uint32_t lineHead     = 0;
+    uint64_t bytesFetched = 0;
+
+    for (uint32_t v : indices) {
+        if (insertedAt[v] != UINT32_MAX && vmisses - insertedAt[v] < VCACHE_SIZE) {
+            continue;
+        }
+
+        insertedAt[v] = vmisses++;
+
+        uint64_t firstLine = (uint64_t(v) * vertexSize) / LINE_SIZE;
+        uint64_t lastLine  = (uint64_t(v) * vertexSize + vertexSize - 1) / LINE_SIZE;
+
+        for (uint64_t line = firstLine; line <= lastLine; ++line) {
+            if (std::find(std::begin(lines), std::end(lines), line) != std::end(lines)) {
+                continue;
+            }
+
+            lines[lineHead] = line;
+            lineHead = (lineHead + 1) % LINE_COUNT;
+            bytesFetched += LINE_SIZE;
+        }
+    }
+
+    stats.overfetch = float(double(bytesFetched) / (double(vertexCount) * vertexSize));
+    return stats;
+}
+
+#pragma endregion
@@ -0,0 +1,383 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+// symmetric 4x4 plane quadric plus the accumulated area, error = Q(p) / weight
+struct Quadric {
+    double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+    double b0  = 0, b1  = 0, b2  = 0;
+    double c   = 0;
+    double weight = 0;
+
+    void AddPlane(double nx, double ny, double nz, double d, double w) {
+        a00 += w * nx * nx;  a11 += w * ny * ny;  a22 += w * nz * nz;
+        a01 += w * nx * ny;  a02 += w * nx * nz;  a12 += w * ny * nz;
+        b0  += w * nx * d;   b1  += w * ny * d;   b2  += w * nz * d;
+        c   += w * d * d;
+        weight += w;
+    }
+
+    void Add(const Quadric& q) {
+        a00 += q.a00;  a11 += q.a11;  a22 += q.a22;
+        a01 += q.a01;  a02 += q.a02;  a12 += q.a12;
+        b0  += q.b0;   b1  += q.b1;   b2  += q.b2;
+        c   += q.c;
+        weight += q.weight;
+    }
+
+    double Evaluate(const float p[3]) const {
+        double x = p[0], y = p[1], z = p[2];
+
+        double e = a00 * x * x + a11 * y * y + a22 * z * z
+                 + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                 + 2.0 * (b0 * x + b1 * y + b2 * z)
+                 + c;
+
+        return std::max(e, 0.0);
+    }
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double   cost;      // squared object space distance
+};
+
+inline void Cross(const float a[3], const float b[3], const float c[3], float n[3]) {
+    float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+
+    n[0] = e0[1] * e1[2] - e0[2] * e1[1];
+    n[1] = e0[2] * e1[0] - e0[0] * e1[2];
+    n[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+class Simplifier {
+public:
+    explicit Simplifier(const MeshData& mesh)
+        : mesh(mesh)
+        , quadrics(mesh.vertices.size())
+        , locked(mesh.vertices.size(), 0) {
+    }
+
+    // quadrics come from the full detail triangles; seams and borders are found there too
+    void Prepare(const std::vector<uint32_t>& indices) {
+        const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+
+        // vertices sharing a position with another vertex sit on an attribute seam
+        struct PositionHash {
+            size_t operator()(const std::array<uint32_t, 3>& k) const {
+                return (size_t(k[0]) * 73856093u) ^ (size_t(k[1]) * 19349663u) ^ (size_t(k[2]) * 83492791u);
+            }
+        };
+
+        std::unordered_map<std::array<uint32_t, 3>, uint32_t, PositionHash> firstAt;
+        firstAt.reserve(vertexCount);
+
+        std::vector<uint32_t> weld(vertexCount);
+
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            std::array<uint32_t, 3> key;
+            std::memcpy(key.data(), mesh.vertices[v].position, sizeof(key));
+
+            auto it = firstAt.emplace(key, v).first;
+            weld[v] = it->second;
+
+            if (it->second != v) {
+                locked[v] = locked[it->second] = 1;
+            }
+        }
+
+        // border edges have no opposite half edge
+        std::unordered_map<uint64_t, uint32_t> halfEdges;
+        halfEdges.reserve(indices.size());
+
+        auto edgeKey = [](uint32_t a, uint32_t b) { return (uint64_t(a) << 32) | b; };
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = weld[indices[i + e]];
+                uint32_t b = weld[indices[i + (e + 1) % 3]];
+                halfEdges[edgeKey(a, b)]++;
+            }
+        }
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = indices[i + e];
+                uint32_t b = indices[i + (e + 1) % 3];
+
+                if (halfEdges.find(edgeKey(weld[b], weld[a])) == halfEdges.end()) {
+                    locked[a] = locked[b] = 1;
+                }
+            }
+        }
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const float* p0 = mesh.vertices[indices[i + 0]].position;
+            const float* p1 = mesh.vertices[indices[i + 1]].position;
+            const float* p2 = mesh.vertices[indices[i + 2]].position;
+
+            float n[3];
+            Cross(p0, p1, p2, n);
+
+            double len = std::sqrt(double(n[0]) * n[0] + double(n[1]) * n[1] + double(n[2]) * n[2]);
+            if (len == 0.0) {
+                continue;
+            }
+
+            double nx = n[0] / len, ny = n[1] / len, nz = n[2] / len;
+            double d  = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+            double w  = 0.5 * len;
+
+            for (int c = 0; c < 3; ++c) {
+                quadrics[indices[i + c]].AddPlane(nx, ny, nz, d, w);
+            }
+        }
+    }
+
+    // collapses in place until indices.size() <= targetIndexCount or nothing fits in maxError
+    float Run(std::vector<uint32_t>& indices, uint32_t targetIndexCount, float maxError) {
+        const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        const double   maxCost     = double(maxError) * maxError;
+
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<uint8_t>  busy(vertexCount);
+        std::vector<uint32_t> adjOffset(vertexCount + 1);
+        std::vector<uint32_t> adjTris;
+        std::vector<Collapse> candidates;
+
+        float resultError = 0.0f;
+
+        while (indices.size() > targetIndexCount) {
+            const uint32_t triCount = static_cast<uint32_t>(indices.size() / 3);
+
+            // vertex -> triangle adjacency in CSR form, for the flip test
+            std::fill(adjOffset.begin(), adjOffset.end(), 0);
+            for (uint32_t idx : indices) {
+                adjOffset[idx + 1]++;
+            }
+
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                adjOffset[v + 1] += adjOffset[v];
+            }
+
+            adjTris.resize(indices.size());
+            {
+                std::vector<uint32_t> cursor(adjOffset.begin(), adjOffset.end() - 1);
+                for (uint32_t t = 0; t < triCount; ++t) {
+                    for (int c = 0; c < 3; ++c) {
+                        adjTris[cursor[indices[t * 3 + c]]++] = t;
+                    }
+                }
+            }
+
+            // both directions of every edge, the shared one is cheapest first after sorting
+            candidates.clear();
+
+            for (uint32_t t = 0; t < triCount; ++t) {
+                for (int e = 0; e < 3; ++e) {
+                    uint32_t a = indices[t * 3 + e];
+                    uint32_t b = indices[t * 3 + (e + 1) % 3];
+
+                    if (!locked[a]) {
+                        candidates.push_back({ a, b, Cost(a, b) });
+                    }
+
+                    if (!locked[b]) {
+                        candidates.push_back({ b, a, Cost(b, a) });
+                    }
+                }
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [](const Collapse& x, const Collapse& y) {
+                return x.cost < y.cost;
+            });
+
+            // every collapse removes about two triangles
+            uint32_t wanted    = (static_cast<uint32_t>(indices.size()) - targetIndexCount) / 6 + 1;
+            uint32_t collapsed = 0;
+
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                remap[v] = v;
+            }
+
+            std::fill(busy.begin(), busy.end(), 0);
+
+            for (const Collapse& c : candidates) {
+                if (c.cost > maxCost || collapsed >= wanted) {
+                    break;
+                }
+
+                if (busy[c.from] || busy[c.to] || Flips(indices, adjOffset, adjTris, c.from, c.to)) {
+                    continue;
+                }
+
+                // the whole one ring of the moved vertex is off limits for the rest of the pass
+                for (uint32_t k = adjOffset[c.from]; k < adjOffset[c.from + 1]; ++k) {
+                    const uint32_t* tri = &indices[adjTris[k] * 3];
+                    busy[tri[0]] = busy[tri[1]] = busy[tri[2]] = 1;
+                }
+
+                busy[c.to] = 1;
+
+                remap[c.from] = c.to;
+                quadrics[c.to].Add(quadrics[c.from]);
+
+                resultError = std::max(resultError, float(std::sqrt(c.cost)));
+                collapsed++;
+            }
+
+            if (collapsed == 0) {
+                break;
+            }
+
+            // rewrite and drop what collapsed to a line
+            size_t write = 0;
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                uint32_t a = remap[indices[i + 0]];
+                uint32_t b = remap[indices[i + 1]];
+                uint32_t c = remap[indices[i + 2]];
+
+                if (a != b && b != c && c != a) {
+                    indices[write++] = a;
+                    indices[write++] = b;
+                    indices[write++] = c;
+                }
+            }
+
+            indices.resize(write);
+        }
+
+        return resultError;
+    }
+
+private:
+    double Cost(uint32_t from, uint32_t to) const {
+        Quadric q = quadrics[from];
+        q.Add(quadrics[to]);
+
+        return q.weight > 0.0 ? q.Evaluate(mesh.vertices[to].position) / q.weight : 0.0;
+    }
+
+    bool Flips(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& adjOffset,
+               const std::vector<uint32_t>& adjTris, uint32_t from, uint32_t to) const {
+        for (uint32_t k = adjOffset[from]; k < adjOffset[from + 1]; ++k) {
+            const uint32_t* tri = &indices[adjTris[k] * 3];
+
+            if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                continue;   // collapses away
+            }
+
+            const float* p[3];
+            const float* q[3];
+
+            for (int c = 0; c < 3; ++c) {
+                p[c] = mesh.vertices[tri[c]].position;
+                q[c] = (tri[c] == from) ? mesh.vertices[to].position : p[c];
+            }
+
+            float before[3], after[3];
+            Cross(p[0], p[1], p[2], before);
+            Cross(q[0], q[1], q[2], after);
+
+            if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0f) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const MeshData&       mesh;
+    std::vector<Quadric>  quadrics;
+    std::vector<uint8_t>  locked;
+};
+
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(const MeshData& mesh, const std::vector<uint32_t>& indices, uint32_t targetIndexCount,
+                                               float targetError, float* resultError) {
+    Simplifier simplifier(mesh);
+    simplifier.Prepare(indices);
+
+    std::vector<uint32_t> result = indices;
+    float error = simplifier.Run(result, targetIndexCount, targetError);
+
+    if (resultError) {
+        *resultError = error;
+    }
+
+    return result;
+}
+
+std::vector<MeshLod> MeshSimplifier::BuildLodChain(MeshData& mesh, uint32_t lodCount, float ratio, float maxRelativeError) {
+    std::vector<MeshLod> lods;
+
+    MeshLod base;
+    base.indexCount = mesh.IndexCount();
+    lods.push_back(base);
+
+    lodCount = std::min(lodCount, MAX_LODS);
+    if (lodCount <= 1 || mesh.indices.empty()) {
+        return lods;
+    }
+
+    float diagonal = 0.0f;
+    for (int c = 0; c < 3; ++c) {
+        float e = mesh.boundsMax[c] - mesh.boundsMin[c];
+        diagonal += e * e;
+    }
+
+    const float maxError = std::sqrt(diagonal) * maxRelativeError;
+    const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+
+    Simplifier simplifier(mesh);
+    simplifier.Prepare(mesh.indices);
+
+    // every level continues from the previous one, quadrics carry the merged history
+    std::vector<uint32_t> level = mesh.indices;
+    float error = 0.0f;
+
+    while (lods.size() < lodCount) {
+        uint32_t previous = static_cast<uint32_t>(level.size());
+        uint32_t target   = static_cast<uint32_t>(previous / 3 * ratio) * 3;
+
+        error = std::max(error, simplifier.Run(level, target, maxError));
+
+        if (level.size() > previous * 9 / 10 || level.empty()) {
+            break;
+        }
+
+        MeshLod lod;
+        lod.firstIndex = mesh.IndexCount();
+        lod.indexCount = static_cast<uint32_t>(level.size());
+        lod.error      = error;
+
+        // each level gets its own vertex cache order
+        std::vector<uint32_t> ordered = MeshOptimizer::OptimizeVertexCache(level, vertexCount, MeshOptimizer::DEFAULT_CACHE_SIZE);
+        mesh.indices.insert(mesh.indices.end(), ordered.begin(), ordered.end());
+
+        lods.push_back(lod);
+    }
+
+    return lods;
+}
+
+void MeshSimplifier::PrintLods(const std::vector<MeshLod>& lods) {
+    std::cout << "LODs:";
+
+    for (size_t i = 0; i < lods.size(); ++i) {
+        std::cout << (i ? ", " : " ") << lods[i].indexCount / 3 << " triangles (error " << lods[i].error << ")";
+    }
+
+    std::cout << std::endl;
+}
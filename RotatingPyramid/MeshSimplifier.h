@@ -0,0 +1,41 @@
+#pragma once
+
+#include "MeshLoader.h"
+
+#include <cstdint>
+#include <vector>
+
+// One level of detail: a range of the shared index buffer drawn over the shared vertices.
+struct MeshLod {
+    uint32_t firstIndex   = 0;
+    uint32_t indexCount   = 0;
+    float    error        = 0.0f;   // object space distance to the full detail surface
+    uint32_t firstMeshlet = 0;      // filled in when the LOD is cut into meshlets
+    uint32_t meshletCount = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Quadric error metric simplification (Garland & Heckbert 1997) restricted to collapsing
+// a vertex onto a neighbour, so every level only needs its own index list.
+//
+// Area weighted face quadrics are accumulated once from the full detail mesh and merged
+// on every collapse, which keeps the error of each level relative to the original.
+// Vertices on open borders or uv / normal seams are locked so attributes never stretch.
+// Collapses run in passes: cheapest first, one collapse per vertex neighbourhood per pass,
+// rejected when any triangle around the moved vertex would flip.
+class MeshSimplifier {
+public:
+    static constexpr uint32_t MAX_LODS = 6;
+
+    // Simplifies in steps of ratio, appending every level's indices to mesh.indices.
+    // Returns the chain with LOD 0 (the original indices) first. Stops early when a level
+    // can't drop 10% of the previous one's triangles within maxRelativeError (a fraction
+    // of the bounding box diagonal).
+    static std::vector<MeshLod> BuildLodChain(MeshData& mesh, uint32_t lodCount = 5, float ratio = 0.5f, float maxRelativeError = 0.05f);
+
+    // one shot: reduces towards targetIndexCount, never past targetError (object space)
+    static std::vector<uint32_t> Simplify(const MeshData& mesh, const std::vector<uint32_t>& indices, uint32_t targetIndexCount,
+                                          float targetError, float* resultError = nullptr);
+
+    static void PrintLods(const std::vector<MeshLod>& lods);
+};
@@ -0,0 +1,193 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+inline float Dot(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline float DistanceSq(const float a[3], const float b[3]) {
+    float d[3] = { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+    return Dot(d, d);
+}
+
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(const MeshData& mesh) {
+    return Build(mesh, 0, mesh.IndexCount());
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(const MeshData& mesh, uint32_t firstIndex, uint32_t indexCount,
+                                           uint32_t maxVertices, uint32_t maxTriangles) {
+    std::vector<Meshlet> meshlets;
+
+    // last meshlet that referenced each vertex, to count unique vertices without clearing
+    std::vector<uint32_t> owner(mesh.vertices.size(), UINT32_MAX);
+
+    Meshlet current{};
+    current.firstIndex = firstIndex;
+
+    uint32_t id = 0;
+
+    auto finish = [&](uint32_t nextIndex) {
+        if (current.indexCount == 0) {
+            return;
+        }
+
+        ComputeBounds(mesh, current);
+        meshlets.push_back(current);
+
+        current            = Meshlet{};
+        current.firstIndex = nextIndex;
+        id++;
+    };
+
+    const uint32_t endIndex = firstIndex + indexCount;
+
+    for (uint32_t i = firstIndex; i + 2 < endIndex; i += 3) {
+        const uint32_t* tri = &mesh.indices[i];
+
+        uint32_t newVertices = (owner[tri[0]] != id) + (owner[tri[1]] != id && tri[1] != tri[0])
+                             + (owner[tri[2]] != id && tri[2] != tri[0] && tri[2] != tri[1]);
+
+        if (current.vertexCount + newVertices > maxVertices || current.indexCount / 3 + 1 > maxTriangles) {
+            finish(i);
+            newVertices = 1 + (tri[1] != tri[0]) + (tri[2] != tri[0] && tri[2] != tri[1]);
+        }
+
+        owner[tri[0]] = owner[tri[1]] = owner[tri[2]] = id;
+
+        current.vertexCount += newVertices;
+        current.indexCount  += 3;
+    }
+
+    finish(endIndex);
+
+    return meshlets;
+}
+
+void MeshletBuilder::ComputeBounds(const MeshData& mesh, Meshlet& meshlet) {
+    const uint32_t* indices = mesh.indices.data() + meshlet.firstIndex;
+
+    auto position = [&](uint32_t i) { return mesh.vertices[indices[i]].position; };
+
+    // Ritter: span between two far apart points, then grow to cover the stragglers
+    const float* p0 = position(0);
+    const float* p1 = p0;
+    const float* p2 = p0;
+
+    for (uint32_t i = 0; i < meshlet.indexCount; ++i) {
+        if (DistanceSq(position(i), p0) > DistanceSq(p1, p0)) {
+            p1 = position(i);
+        }
+    }
+
+    for (uint32_t i = 0; i < meshlet.indexCount; ++i) {
+        if (DistanceSq(position(i), p1) > DistanceSq(p2, p1)) {
+            p2 = position(i);
+        }
+    }
+
+    float center[3] = { 0.5f * (p1[0] + p2[0]), 0.5f * (p1[1] + p2[1]), 0.5f * (p1[2] + p2[2]) };
+    float radius    = 0.5f * std::sqrt(DistanceSq(p1, p2));
+
+    for (uint32_t i = 0; i < meshlet.indexCount; ++i) {
+        const float* p = position(i);
+        float d = std::sqrt(DistanceSq(p, center));
+
+        if (d > radius) {
+            float grow = 0.5f * (d - radius);
+            radius += grow;
+
+            for (int c = 0; c < 3; ++c) {
+                center[c] += (p[c] - center[c]) * (grow / d);
+            }
+        }
+    }
+
+    // normal cone from unit face normals, degenerate triangles don't vote
+    std::vector<float> normals;
+    normals.reserve(meshlet.indexCount);
+
+    float axis[3] = {};
+
+    for (uint32_t i = 0; i < meshlet.indexCount; i += 3) {
+        const float* a = position(i);
+        const float* b = position(i + 1);
+        const float* c = position(i + 2);
+
+        float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float n[3]  = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+
+        float len = std::sqrt(Dot(n, n));
+        if (len == 0.0f) {
+            continue;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            n[k] /= len;
+            axis[k] += n[k];
+            normals.push_back(n[k]);
+        }
+    }
+
+    float axisLen = std::sqrt(Dot(axis, axis));
+    float minDot  = 1.0f;
+
+    if (axisLen > 0.0f) {
+        for (int k = 0; k < 3; ++k) {
+            axis[k] /= axisLen;
+        }
+
+        for (size_t i = 0; i < normals.size(); i += 3) {
+            minDot = std::min(minDot, Dot(axis, &normals[i]));
+        }
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        meshlet.center[c]   = center[c];
+        meshlet.coneAxis[c] = axis[c];
+    }
+
+    meshlet.radius = radius;
+
+    // the cone is widened by 90 degrees on both sides for the backface test, which makes
+    // the cutoff sin(spread); near hemispherical clusters can never be culled
+    meshlet.coneCutoff = (axisLen > 0.0f && minDot > 0.1f) ? std::sqrt(1.0f - minDot * minDot) : 1.0f;
+}
+
+MeshletBuilder::Stats MeshletBuilder::Analyze(const std::vector<Meshlet>& meshlets) {
+    Stats stats;
+
+    if (meshlets.empty()) {
+        return stats;
+    }
+
+    uint64_t vertexSum   = 0;
+    uint64_t triangleSum = 0;
+    uint32_t cullable    = 0;
+
+    for (const Meshlet& m : meshlets) {
+        vertexSum   += m.vertexCount;
+        triangleSum += m.indexCount / 3;
+        cullable    += (m.coneCutoff < 1.0f) ? 1 : 0;
+    }
+
+    stats.meshletCount     = static_cast<uint32_t>(meshlets.size());
+    stats.averageVertices  = float(vertexSum) / meshlets.size();
+    stats.averageTriangles = float(triangleSum) / meshlets.size();
+    stats.coneCullable     = float(cullable) / meshlets.size();
+
+    return stats;
+}
+
+void MeshletBuilder::PrintStats(const Stats& stats) {
+    std::cout << "Meshlets: " << stats.meshletCount
+              << ", " << stats.averageVertices << " vertices / " << stats.averageTriangles << " triangles on average"
+              << ", " << stats.coneCullable * 100.0f << "% backface cullable" << std::endl;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "MeshLoader.h"
+
+#include <cstdint>
+#include <vector>
+
+// One cluster of the index buffer, laid out for the cull shader (std430, 48 bytes).
+// Bounds are in the mesh's float object space, before any vertex quantization.
+struct Meshlet {
+    float    center[3];
+    float    radius;
+    float    coneAxis[3];       // average facing of the triangles
+    float    coneCutoff;        // sin of the cone's half angle, 1 when the cone can't cull
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t vertexCount;       // unique vertices referenced
+    uint32_t pad;
+};
+
+static_assert(sizeof(Meshlet) == 48, "Meshlet must match cull.comp");
+
+// Cuts the (already reordered) triangle list into contiguous runs of at most maxVertices
+// unique vertices and maxTriangles triangles, so each meshlet is one indexed draw and the
+// vertex cache order from MeshOptimizer is kept.
+class MeshletBuilder {
+public:
+    static constexpr uint32_t MAX_VERTICES  = 64;
+    static constexpr uint32_t MAX_TRIANGLES = 124;
+
+    struct Stats {
+        uint32_t meshletCount      = 0;
+        float    averageVertices   = 0.0f;
+        float    averageTriangles  = 0.0f;
+        float    coneCullable      = 0.0f;  // fraction with a usable normal cone
+    };
+
+    static std::vector<Meshlet> Build(const MeshData& mesh);
+
+    // only indices [firstIndex, firstIndex + indexCount), e.g. one LOD of a shared index buffer
+    static std::vector<Meshlet> Build(const MeshData& mesh, uint32_t firstIndex, uint32_t indexCount,
+                                      uint32_t maxVertices = MAX_VERTICES, uint32_t maxTriangles = MAX_TRIANGLES);
+
+    static Stats Analyze(const std::vector<Meshlet>& meshlets);
+    static void  PrintStats(const Stats& stats);
+
+    // bounding sphere & normal cone of triangles [firstIndex, firstIndex + indexCount)
+    static void  ComputeBounds(const MeshData& mesh, Meshlet& meshlet);
+};
@@ -0,0 +1,235 @@
+// CPU side hot paths of the renderer, without a window or a device:
+//
+//     Microbenchmarks [--benchmark_filter=<regex>] [--benchmark_format=json]
+//
+// Built when CMake finds Google Benchmark.
+
+#include <benchmark/benchmark.h>
+
+#include "Camera.h"
+#include "DeletionQueue.h"
+#include "MeshLoader.h"
+#include "Scene.h"
+#include "VertexQuantizer.h"
+#include "VulkanUtil.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// memory heaps and types the way a discrete GPU reports them: device local first, the host
+// visible ones towards the end
+VkPhysicalDeviceMemoryProperties DiscreteGpuMemory() {
+    VkPhysicalDeviceMemoryProperties props {};
+
+    const VkMemoryPropertyFlags types[] = {
+        0,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+        0,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+    };
+
+    props.memoryTypeCount = sizeof(types) / sizeof(types[0]);
+    props.memoryHeapCount = 2;
+
+    for (uint32_t i = 0; i < props.memoryTypeCount; ++i) {
+        props.memoryTypes[i].propertyFlags = types[i];
+        props.memoryTypes[i].heapIndex     = (types[i] & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) ? 0 : 1;
+    }
+
+    return props;
+}
+
+// a wavy grid of (n + 1)^2 vertices and 2 n^2 triangles
+MeshData GridMesh(uint32_t n) {
+    MeshData mesh;
+
+    for (uint32_t y = 0; y <= n; ++y) {
+        for (uint32_t x = 0; x <= n; ++x) {
+            const float u = float(x) / n;
+            const float v = float(y) / n;
+
+            mesh.vertices.push_back({ { u - 0.5f, 0.1f * std::sin(8.0f * u) * std::cos(8.0f * v), v - 0.5f },
+                                      { u, v, 1.0f - u },
+                                      { u, v } });
+        }
+    }
+
+    for (uint32_t y = 0; y < n; ++y) {
+        for (uint32_t x = 0; x < n; ++x) {
+            const uint32_t i = y * (n + 1) + x;
+
+            mesh.indices.insert(mesh.indices.end(), { i, i + n + 1, i + 1, i + 1, i + n + 1, i + n + 2 });
+        }
+    }
+
+    mesh.ComputeBounds();
+
+    return mesh;
+}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// SearchMemoryType / HasMemoryType, over every usage the renderer asks for
+static void BM_FindMemoryType(benchmark::State& state) {
+    const VkPhysicalDeviceMemoryProperties props = DiscreteGpuMemory();
+
+    const VkMemoryPropertyFlags queries[] = {
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+    };
+
+    for (auto _ : state) {
+        for (VkMemoryPropertyFlags flags : queries) {
+            benchmark::DoNotOptimize(FindMemoryType(props, 0xFFu, flags));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 4);
+}
+BENCHMARK(BM_FindMemoryType);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// UpdateUbo's math: the animated transforms, camera matrices, cull planes and cull eye
+static void BM_FrameMatrices(benchmark::State& state) {
+    Scene scene;
+
+    Scene::NodeId pivotNode   = scene.AddNode(Scene::INVALID_NODE);
+    Scene::NodeId pyramidNode = scene.AddNode(pivotNode);
+    Scene::NodeId meshNode    = scene.AddNode(pyramidNode);
+    Scene::NodeId dequantNode = scene.AddNode(meshNode);
+
+    scene.UpdateTransforms();
+
+    float     time = 0.0f;
+    glm::vec4 planes[6];
+
+    for (auto _ : state) {
+        time += 1.0f / 60.0f;
+
+        Scene::Transform pivot;
+        pivot.rotation = glm::angleAxis(time * glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        Scene::Transform bob;
+        bob.translation = glm::vec3(0.0f, (glm::sin(time * 5) * 0.25f) - 0.25f, 0.0f);
+
+        scene.SetLocalTransform(pivotNode, pivot);
+        scene.SetLocalTransform(pyramidNode, bob);
+        scene.UpdateTransforms();
+
+        const glm::mat4  view        = Camera::View();
+        const glm::mat4  viewProj    = Camera::Clip() * Camera::Projection(16.0f / 9.0f) * view;
+        const glm::mat4& meshToWorld = scene.GetWorldMatrix(meshNode);
+
+        Camera::FrustumPlanes(viewProj * meshToWorld, planes);
+
+        glm::vec3 eye = glm::vec3(glm::inverse(view * meshToWorld)[3]);
+
+        benchmark::DoNotOptimize(scene.GetWorldMatrix(dequantNode));
+        benchmark::DoNotOptimize(planes);
+        benchmark::DoNotOptimize(eye);
+    }
+}
+BENCHMARK(BM_FrameMatrices);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// deleters shaped like the renderer's: a device and a handle or two captured by value
+static void BM_DeletionQueue(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+
+    uint64_t destroyed = 0;
+
+    for (auto _ : state) {
+        DeletionQueue queue;
+
+        for (size_t i = 0; i < count; ++i) {
+            queue.Append(
+                [ cdevice = reinterpret_cast<void*>(i)
+                , chandle = uint64_t(i)
+                , &destroyed ] {
+                    destroyed += chandle + (cdevice != nullptr);
+                }
+            );
+        }
+
+        queue.Finalize();
+    }
+
+    benchmark::DoNotOptimize(destroyed);
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DeletionQueue)->Arg(64)->Arg(4096)->Arg(65536);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// vertex buffer packing for each format, and 16 bit index narrowing
+static void BM_PackVertices(benchmark::State& state) {
+    const MeshData mesh = GridMesh(static_cast<uint32_t>(state.range(0)));
+
+    const VertexQuantizer::Mode mode = static_cast<VertexQuantizer::Mode>(state.range(1));
+    const VertexEncoding encoding    = VertexQuantizer::Choose(mesh, mode);
+
+    std::vector<uint8_t> buffer(VertexQuantizer::BufferSize(mesh, encoding));
+
+    for (auto _ : state) {
+        VertexQuantizer::Pack(mesh, encoding, buffer.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * mesh.vertices.size());
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_PackVertices)
+    ->Args({ 255, int64_t(VertexQuantizer::Mode::Float) })
+    ->Args({ 255, int64_t(VertexQuantizer::Mode::Half) })
+    ->Args({ 255, int64_t(VertexQuantizer::Mode::Snorm16) });
+
+static void BM_WriteIndices(benchmark::State& state) {
+    const MeshData mesh = GridMesh(static_cast<uint32_t>(state.range(0)));
+
+    std::vector<uint8_t> buffer(mesh.IndexBufferSize());
+
+    for (auto _ : state) {
+        mesh.WriteIndices(buffer.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * mesh.indices.size());
+}
+BENCHMARK(BM_WriteIndices)->Arg(255)->Arg(511);     // 16 and 32 bit indices
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// the descriptor writes of CreateDescriptorPoolAndSets, for every frame in flight
+static void BM_DescriptorWrites(benchmark::State& state) {
+    const uint32_t frames = 3;
+
+    std::array<VkDescriptorSet, frames>        sets    = {};
+    std::array<VkDescriptorBufferInfo, frames> buffers = {};
+
+    VkDescriptorImageInfo imageInfo { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+    for (auto _ : state) {
+        std::array<VkWriteDescriptorSet, 2 * frames> writes;
+
+        for (uint32_t i = 0; i < frames; ++i) {
+            writes[2 * i]     = BufferDescriptorWrite(sets[i], 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &buffers[i]);
+            writes[2 * i + 1] = ImageDescriptorWrite(sets[i], 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &imageInfo);
+        }
+
+        benchmark::DoNotOptimize(writes);
+    }
+}
+BENCHMARK(BM_DescriptorWrites);
+
+BENCHMARK_MAIN();
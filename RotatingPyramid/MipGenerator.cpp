@@ -0,0 +1,148 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_GENERATOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// fine enough that the darkest sRGB steps (slope 12.92) still round correctly
+constexpr uint32_t ENCODE_TABLE_SIZE = 16384;
+
+struct SrgbTables {
+    float   decode[256];
+    uint8_t encode[ENCODE_TABLE_SIZE];
+
+    SrgbTables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            decode[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        for (uint32_t i = 0; i < ENCODE_TABLE_SIZE; ++i) {
+            float l = float(i) / (ENCODE_TABLE_SIZE - 1);
+            float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            encode[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+        }
+    }
+};
+
+const SrgbTables& Tables() {
+    static const SrgbTables tables;
+    return tables;
+}
+
+}
+
+uint32_t MipGenerator::MipLevelCount(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+        levels++;
+    }
+    return levels;
+}
+
+void MipGenerator::Downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, bool srgb) {
+    const SrgbTables& t = Tables();
+
+    const uint32_t dstWidth  = std::max(srcWidth / 2, 1u);
+    const uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+
+    // colour lanes decode to [0, 1] linear, alpha stays in [0, 255]
+    const float* colorDecode = t.decode;
+    float        unormDecode[256];
+
+    if (!srgb) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            unormDecode[i] = i / 255.0f;
+        }
+        colorDecode = unormDecode;
+    }
+
+    for (uint32_t y = 0; y < dstHeight; ++y) {
+        const uint8_t* row0 = src + size_t(std::min(2 * y,     srcHeight - 1)) * srcWidth * 4;
+        const uint8_t* row1 = src + size_t(std::min(2 * y + 1, srcHeight - 1)) * srcWidth * 4;
+
+        uint8_t* out = dst + size_t(y) * dstWidth * 4;
+
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            const uint32_t x0 = std::min(2 * x,     srcWidth - 1) * 4;
+            const uint32_t x1 = std::min(2 * x + 1, srcWidth - 1) * 4;
+
+            const uint8_t* p[4] = { row0 + x0, row0 + x1, row1 + x0, row1 + x1 };
+
+#ifdef MIP_GENERATOR_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < 4; ++k) {
+                sum = _mm_add_ps(sum, _mm_set_ps(float(p[k][3]), colorDecode[p[k][2]], colorDecode[p[k][1]], colorDecode[p[k][0]]));
+            }
+
+            // average and scale to table index (colour) or unorm (alpha) in one multiply
+            const float  tableMax = float(ENCODE_TABLE_SIZE - 1);
+            const __m128 scale    = _mm_set_ps(0.25f, 0.25f * tableMax, 0.25f * tableMax, 0.25f * tableMax);
+
+            alignas(16) int32_t q[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(q), _mm_cvtps_epi32(_mm_mul_ps(sum, scale)));
+#else
+            float sum[4] = {};
+            for (int k = 0; k < 4; ++k) {
+                for (int c = 0; c < 3; ++c) {
+                    sum[c] += colorDecode[p[k][c]];
+                }
+                sum[3] += float(p[k][3]);
+            }
+
+            const float tableMax = float(ENCODE_TABLE_SIZE - 1);
+
+            int32_t q[4] = {
+                int32_t(std::lround(sum[0] * 0.25f * tableMax)),
+                int32_t(std::lround(sum[1] * 0.25f * tableMax)),
+                int32_t(std::lround(sum[2] * 0.25f * tableMax)),
+                int32_t(std::lround(sum[3] * 0.25f)),
+            };
+#endif
+
+            for (int c = 0; c < 3; ++c) {
+                uint32_t index = static_cast<uint32_t>(std::clamp<int32_t>(q[c], 0, ENCODE_TABLE_SIZE - 1));
+
+                out[x * 4 + c] = srgb
+                    ? t.encode[index]
+                    : static_cast<uint8_t>((index * 255u + (ENCODE_TABLE_SIZE - 1) / 2) / (ENCODE_TABLE_SIZE - 1));
+            }
+
+            out[x * 4 + 3] = static_cast<uint8_t>(std::clamp<int32_t>(q[3], 0, 255));
+        }
+    }
+}
+
+std::vector<MipGenerator::Level> MipGenerator::Generate(const uint8_t* rgba, uint32_t width, uint32_t height, bool srgb, std::vector<uint8_t>& chain) {
+    const uint32_t levelCount = MipLevelCount(width, height);
+
+    std::vector<Level> levels;
+    levels.reserve(levelCount);
+
+    size_t total = 0;
+    for (uint32_t i = 0, w = width, h = height; i < levelCount; ++i) {
+        levels.push_back({ w, h, total });
+        total += size_t(w) * h * 4;
+
+        w = std::max(w / 2, 1u);
+        h = std::max(h / 2, 1u);
+    }
+
+    chain.resize(total);
+    std::memcpy(chain.data(), rgba, size_t(width) * height * 4);
+
+    // each level from the one above, which is already in cache
+    for (uint32_t i = 1; i < levelCount; ++i) {
+        const Level& s = levels[i - 1];
+        Downsample(chain.data() + s.offset, s.width, s.height, chain.data() + levels[i].offset, srgb);
+    }
+
+    return levels;
+}
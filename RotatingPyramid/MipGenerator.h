@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Load time mip chain for RGBA8 images. Colour is averaged in linear light (sRGB decoded
+// through a table, re-encoded through a finer one), alpha is averaged as is. One pixel's
+// four channels go through the filter as one SSE vector where available.
+class MipGenerator {
+public:
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        size_t   offset;    // bytes into the packed chain
+    };
+
+    // levels down to 1x1
+    static uint32_t MipLevelCount(uint32_t width, uint32_t height);
+
+    // packs level 0 (a copy of rgba) followed by every smaller level into chain
+    static std::vector<Level> Generate(const uint8_t* rgba, uint32_t width, uint32_t height, bool srgb, std::vector<uint8_t>& chain);
+
+    // 2x2 box filter, odd edges clamp; dst is max(w / 2, 1) x max(h / 2, 1)
+    static void Downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, bool srgb);
+};
@@ -0,0 +1,215 @@
+// Builds an asset pack from directories of shaders and textures:
+//
+//     PackTool <out.pak> <root> <dir> [<dir> ...]
+//
+// Entries are named by their lowercase path relative to root, which is how the runtime asks
+// for them.
+// SPIR-V is stored as is, KTX2 files keep their compressed mips, and PNG/JPEG/TGA/BMP images
+// are decoded and turned into an RGBA8 KTX2 with the full sRGB mip chain.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "AssetPack.h"
+#include "KtxLoader.h"
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<uint8_t> ReadFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open " + path.string());
+    }
+
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+template<typename T>
+void PutLe(std::vector<uint8_t>& out, T v) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+// basic data format descriptor for 8 bit RGBA, sRGB or linear
+void PutRgba8Dfd(std::vector<uint8_t>& out, bool srgb) {
+    const uint32_t blockSize = 24 + 4 * 16;
+
+    PutLe<uint32_t>(out, 4 + blockSize);            // dfdTotalSize
+    PutLe<uint32_t>(out, 0);                        // vendorId, descriptorType: basic
+    PutLe<uint32_t>(out, 2 | (blockSize << 16));    // versionNumber, descriptorBlockSize
+
+    out.push_back(1);                               // colorModel: RGBSDA
+    out.push_back(1);                               // colorPrimaries: BT709
+    out.push_back(srgb ? 2 : 1);                    // transferFunction: sRGB or linear
+    out.push_back(0);                               // flags: straight alpha
+
+    PutLe<uint32_t>(out, 0);                        // texelBlockDimension: 1x1x1x1
+    PutLe<uint32_t>(out, 4);                        // bytesPlane0
+    PutLe<uint32_t>(out, 0);
+
+    const uint8_t channels[4] = { 0, 1, 2, 15 };
+    for (uint32_t c = 0; c < 4; ++c) {
+        PutLe<uint16_t>(out, static_cast<uint16_t>(c * 8));   // bitOffset
+        out.push_back(7);                                       // bitLength - 1
+        out.push_back(channels[c] | ((c == 3 && srgb) ? 0x10 : 0)); // alpha stays linear
+        PutLe<uint32_t>(out, 0);                                // samplePosition
+        PutLe<uint32_t>(out, 0);                                // sampleLower
+        PutLe<uint32_t>(out, 255);                              // sampleUpper
+    }
+}
+
+std::vector<uint8_t> ImageToKtx2(const fs::path& path) {
+    int width, height, channels;
+
+    stbi_uc* pPixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pPixels) {
+        throw std::runtime_error("Could not load image " + path.string());
+    }
+
+    std::vector<uint8_t>             chain;
+    std::vector<MipGenerator::Level> levels = MipGenerator::Generate(pPixels, width, height, true, chain);
+
+    stbi_image_free(pPixels);
+
+    std::vector<uint8_t> dfd;
+    PutRgba8Dfd(dfd, true);
+
+    const uint32_t levelCount = static_cast<uint32_t>(levels.size());
+    const uint64_t dfdOffset  = 80 + 24 * uint64_t(levelCount);
+    const uint64_t dataOffset = (dfdOffset + dfd.size() + 15) & ~uint64_t(15);
+
+    std::vector<uint8_t> out = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    PutLe<uint32_t>(out, VK_FORMAT_R8G8B8A8_SRGB);
+    PutLe<uint32_t>(out, 1);                        // typeSize
+    PutLe<uint32_t>(out, width);
+    PutLe<uint32_t>(out, height);
+    PutLe<uint32_t>(out, 0);                        // pixelDepth
+    PutLe<uint32_t>(out, 0);                        // layerCount
+    PutLe<uint32_t>(out, 1);                        // faceCount
+    PutLe<uint32_t>(out, levelCount);
+    PutLe<uint32_t>(out, 0);                        // supercompressionScheme
+
+    PutLe<uint32_t>(out, static_cast<uint32_t>(dfdOffset));
+    PutLe<uint32_t>(out, static_cast<uint32_t>(dfd.size()));
+    PutLe<uint32_t>(out, 0);                        // kvd
+    PutLe<uint32_t>(out, 0);
+    PutLe<uint64_t>(out, 0);                        // sgd
+    PutLe<uint64_t>(out, 0);
+
+    // KTX2 stores the smallest level first; the chain from MipGenerator is largest first
+    uint64_t levelOffsets[32];
+    uint64_t offset = dataOffset;
+
+    for (uint32_t i = levelCount; i-- > 0; ) {
+        levelOffsets[i] = offset;
+        offset         += uint64_t(levels[i].width) * levels[i].height * 4;
+    }
+
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        const uint64_t size = uint64_t(levels[i].width) * levels[i].height * 4;
+
+        PutLe<uint64_t>(out, levelOffsets[i]);
+        PutLe<uint64_t>(out, size);
+        PutLe<uint64_t>(out, size);                 // uncompressedByteLength
+    }
+
+    out.insert(out.end(), dfd.begin(), dfd.end());
+    out.resize(dataOffset, 0);
+
+    for (uint32_t i = levelCount; i-- > 0; ) {
+        const uint8_t* level = chain.data() + levels[i].offset;
+        out.insert(out.end(), level, level + size_t(levels[i].width) * levels[i].height * 4);
+    }
+
+    return out;
+}
+
+std::string Extension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "usage: PackTool <out.pak> <root> <dir> [<dir> ...]" << std::endl;
+        return 1;
+    }
+
+    const fs::path root(argv[2]);
+
+    std::vector<AssetPack::Source> sources;
+
+    try {
+        for (int i = 3; i < argc; ++i) {
+            for (const fs::directory_entry& file : fs::recursive_directory_iterator(root / argv[i])) {
+                if (!file.is_regular_file()) {
+                    continue;
+                }
+
+                const std::string ext  = Extension(file.path());
+                const std::string name = AssetPack::NormalizeName(fs::relative(file.path(), root).generic_string());
+
+                if (ext == ".spv") {
+                    sources.push_back({ name, AssetType::Spirv, ReadFile(file.path()) });
+                }
+                else if (ext == ".ktx2") {
+                    std::vector<uint8_t> data = ReadFile(file.path());
+
+                    // reject what the runtime couldn't load, at build time
+                    KtxLoader::Parse(data.data(), data.size(), name);
+
+                    sources.push_back({ name, AssetType::Texture, std::move(data) });
+                }
+                else if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".tga" || ext == ".bmp") {
+                    sources.push_back({ name, AssetType::Texture, ImageToKtx2(file.path()) });
+                }
+            }
+        }
+
+        for (const AssetPack::Source& source : sources) {
+            std::cout << source.name << ": " << source.data.size() << " bytes" << std::endl;
+        }
+
+        AssetPack::Write(argv[1], std::move(sources));
+
+        // read it back, which also decompresses every payload once
+        AssetPack pack;
+        pack.Open(argv[1]);
+
+        uint64_t stored = 0;
+        uint64_t total  = 0;
+
+        for (const AssetPackEntry& entry : pack) {
+            std::vector<uint8_t> data(entry.size);
+            pack.Read(entry, data.data());
+
+            stored += entry.storedSize;
+            total  += entry.size;
+        }
+
+        std::cout << "Packed " << (pack.end() - pack.begin()) << " assets into " << argv[1]
+                  << ", " << total << " bytes stored as " << stored << std::endl;
+    }
+    catch (const std::exception& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
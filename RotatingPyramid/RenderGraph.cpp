@@ -0,0 +1,303 @@
+#include "RenderGraph.h"
+
+#include <stdexcept>
+
+namespace {
+
+const VkPipelineStageFlags2 DEPTH_TEST_STAGES = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+const VkPipelineStageFlags2 TRANSFER_STAGES   = VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT;
+
+// indexed by ResourceAccess
+const AccessInfo ACCESS_TABLE[] = {
+    // None
+    { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED, false },
+    // SwapchainAcquire
+    { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED, false },
+    // ComputeShaderWrite
+    { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true },
+    // IndirectCommandRead
+    { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false },
+    // ColorAttachmentWrite
+    { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true },
+    // DepthAttachmentWrite
+    { DEPTH_TEST_STAGES, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true },
+    // FragmentShaderSample
+    { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false },
+    // TransferRead
+    { TRANSFER_STAGES, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false },
+    // TransferWrite
+    { TRANSFER_STAGES, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true },
+    // HostRead: buffers only, the fence wait then makes the writes visible to the host
+    { VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false },
+    // Present: the semaphore signal after the submit orders presentation
+    { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false },
+};
+
+static_assert(sizeof(ACCESS_TABLE) / sizeof(ACCESS_TABLE[0]) == size_t(ResourceAccess::Count), "ACCESS_TABLE out of sync with ResourceAccess");
+
+VkImageMemoryBarrier2 ImageBarrier(VkImage image, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel, uint32_t mipLevelCount,
+                                   VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess, VkImageLayout oldLayout, const AccessInfo& to) {
+    return VkImageMemoryBarrier2 {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        nullptr,
+        srcStages,
+        srcAccess,
+        to.stages,
+        to.access,
+        oldLayout,
+        to.layout,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        image,
+        VkImageSubresourceRange { aspectFlags, baseMipLevel, mipLevelCount, 0, 1 }
+    };
+}
+
+}
+
+const AccessInfo& GetAccessInfo(ResourceAccess access) {
+    return ACCESS_TABLE[static_cast<uint32_t>(access)];
+}
+
+void CmdTransitionImage(VkCommandBuffer cmdBuffer, VkImage image, VkImageAspectFlags aspectFlags, ResourceAccess from, ResourceAccess to, uint32_t baseMipLevel, uint32_t mipLevelCount) {
+    const AccessInfo& src = GetAccessInfo(from);
+
+    // only writes have anything to make available
+    VkImageMemoryBarrier2 barrier = ImageBarrier(image, aspectFlags, baseMipLevel, mipLevelCount,
+                                                 src.stages, src.write ? src.access : VK_ACCESS_2_NONE, src.layout, GetAccessInfo(to));
+
+    VkDependencyInfo dependencyInfo {
+        VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        nullptr,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier
+    };
+
+    vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+}
+
+void RenderGraph::Reset() {
+    resources.clear();
+    needed.clear();
+    passCount = 0;
+}
+
+RenderGraph::Resource RenderGraph::ImportImage(VkImage image, VkImageAspectFlags aspectFlags, ResourceAccess current, uint32_t mipLevels) {
+    const AccessInfo& info = GetAccessInfo(current);
+
+    ResourceState state;
+    state.image       = image;
+    state.aspectFlags = aspectFlags;
+    state.mipLevels   = mipLevels;
+    state.layout      = info.layout;
+
+    if (info.write) {
+        state.writeStages = info.stages;
+        state.writeAccess = info.access;
+    }
+    else {
+        state.readStages  = info.stages;
+    }
+
+    resources.push_back(state);
+
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::ImportBuffer(VkBuffer buffer, ResourceAccess current) {
+    const AccessInfo& info = GetAccessInfo(current);
+
+    ResourceState state;
+    state.buffer = buffer;
+
+    if (info.write) {
+        state.writeStages = info.stages;
+        state.writeAccess = info.access;
+    }
+    else {
+        state.readStages  = info.stages;
+    }
+
+    resources.push_back(state);
+
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::ImportTransientImage(VkImage image, VkImageAspectFlags aspectFlags, ResourceAccess previous) {
+    Resource resource = ImportImage(image, aspectFlags, previous);
+
+    resources[resource].layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    return resource;
+}
+
+void RenderGraph::Export(Resource resource, ResourceAccess final) {
+    resources[resource].exported = true;
+    resources[resource].final    = final;
+}
+
+uint32_t RenderGraph::AddPass(const char* name, RecordFn record) {
+    if (passCount == passes.size()) {
+        passes.emplace_back();
+    }
+
+    Pass& pass  = passes[passCount];
+    pass.name   = name;
+    pass.record = std::move(record);
+    pass.alive  = false;
+    pass.usages.clear();
+
+    return passCount++;
+}
+
+void RenderGraph::Use(uint32_t pass, Resource resource, ResourceAccess access) {
+    const AccessInfo& info   = GetAccessInfo(access);
+    std::vector<Usage>& usages = passes[pass].usages;
+
+    // the same resource twice in a pass is one combined use, in one layout
+    for (Usage& usage : usages) {
+        if (usage.resource != resource) {
+            continue;
+        }
+
+        if (resources[resource].image && usage.info.layout != info.layout) {
+            throw std::runtime_error("Could not use an image in two layouts in one pass!");
+        }
+
+        usage.info.stages |= info.stages;
+        usage.info.access |= info.access;
+        usage.info.write  |= info.write;
+        return;
+    }
+
+    usages.push_back({ resource, info });
+}
+
+void RenderGraph::Transition(ResourceState& state, const AccessInfo& info) {
+    const VkImageLayout oldLayout    = state.layout;
+    const bool          layoutChange = state.image && info.layout != oldLayout;
+
+    VkPipelineStageFlags2 srcStages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2        srcAccess = VK_ACCESS_2_NONE;
+
+    if (layoutChange || info.write) {
+        // write after anything: earlier readers only have to be done, the last write also flushed
+        srcStages = state.writeStages | state.readStages;
+        srcAccess = state.writeAccess;
+
+        // a layout change is a write of its own that later readers wait on
+        state.writeStages = info.stages;
+        state.writeAccess = info.write ? info.access : VK_ACCESS_2_NONE;
+        state.readStages  = info.write ? VK_PIPELINE_STAGE_2_NONE : info.stages;
+        state.layout      = info.layout;
+    }
+    else {
+        // read after read is free, read after write once per reading stage
+        if (info.stages & ~state.readStages) {
+            srcStages = state.writeStages;
+            srcAccess = state.writeAccess;
+        }
+
+        state.readStages |= info.stages;
+    }
+
+    if (layoutChange) {
+        imageBarriers.push_back(ImageBarrier(state.image, state.aspectFlags, 0, state.mipLevels, srcStages, srcAccess, oldLayout, info));
+    }
+    else if (srcStages != VK_PIPELINE_STAGE_2_NONE) {
+        // no layout to change, so one global barrier covers every buffer and image of the pass
+        memoryBarrier.srcStageMask  |= srcStages;
+        memoryBarrier.srcAccessMask |= srcAccess;
+        memoryBarrier.dstStageMask  |= info.stages;
+        memoryBarrier.dstAccessMask |= info.access;
+    }
+}
+
+void RenderGraph::FlushBarriers(VkCommandBuffer cmdBuffer) {
+    const bool memory = memoryBarrier.srcStageMask != VK_PIPELINE_STAGE_2_NONE;
+
+    if (!memory && imageBarriers.empty()) {
+        return;
+    }
+
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+
+    VkDependencyInfo dependencyInfo {
+        VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        nullptr,
+        0,
+        memory ? 1u : 0u, &memoryBarrier,
+        0, nullptr,
+        static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data()
+    };
+
+    vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+
+    barrierCount++;
+
+    imageBarriers.clear();
+    memoryBarrier = {};
+}
+
+void RenderGraph::Execute(VkCommandBuffer cmdBuffer, GpuProfiler* profiler) {
+    culledPassCount = 0;
+    barrierCount    = 0;
+
+    // walking back from the exports, a pass lives if it writes something still needed
+    needed.resize(resources.size());
+
+    for (size_t r = 0; r < resources.size(); ++r) {
+        needed[r] = resources[r].exported;
+    }
+
+    for (uint32_t p = passCount; p-- > 0; ) {
+        Pass& pass = passes[p];
+
+        for (const Usage& usage : pass.usages) {
+            pass.alive = pass.alive || (usage.info.write && needed[usage.resource]);
+        }
+
+        if (!pass.alive) {
+            culledPassCount++;
+            continue;
+        }
+
+        for (const Usage& usage : pass.usages) {
+            needed[usage.resource] = true;
+        }
+    }
+
+    for (uint32_t p = 0; p < passCount; ++p) {
+        Pass& pass = passes[p];
+
+        if (!pass.alive) {
+            continue;
+        }
+
+        if (profiler) {
+            profiler->BeginScope(cmdBuffer, pass.name);
+        }
+
+        for (const Usage& usage : pass.usages) {
+            Transition(resources[usage.resource], usage.info);
+        }
+
+        FlushBarriers(cmdBuffer);
+
+        pass.record(cmdBuffer);
+
+        if (profiler) {
+            profiler->EndScope(cmdBuffer);
+        }
+    }
+
+    for (ResourceState& state : resources) {
+        if (state.exported) {
+            Transition(state, GetAccessInfo(state.final));
+        }
+    }
+
+    FlushBarriers(cmdBuffer);
+}
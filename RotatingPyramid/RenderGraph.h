@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "GpuProfiler.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// The ways a resource is used in a frame. Each one maps to the exact stages, access flags
+// and image layout it needs, which is all barriers are derived from.
+enum class ResourceAccess : uint32_t {
+    None,                   // nothing to wait for, contents undefined
+    SwapchainAcquire,       // just acquired, the acquire semaphore is waited on at colour output
+    ComputeShaderWrite,     // storage buffer / image written by a compute dispatch
+    IndirectCommandRead,    // draw parameters of vkCmdDraw*Indirect
+    ColorAttachmentWrite,   // rendered to with loadOp CLEAR or DONT_CARE, no blending
+    DepthAttachmentWrite,   // depth tested and written
+    FragmentShaderSample,   // sampled image in fragment shaders
+    TransferRead,           // copy / blit source
+    TransferWrite,          // copy / blit destination
+    HostRead,               // mapped memory read on the host after the frame's fence
+    Present,                // handed to the presentation engine
+
+    Count
+};
+
+struct AccessInfo {
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2        access;
+    VkImageLayout         layout;       // only meaningful for images
+    bool                  write;
+};
+
+const AccessInfo& GetAccessInfo(ResourceAccess access);
+
+// single barrier for one-off command buffers (uploads, mip generation) outside the graph
+void CmdTransitionImage(VkCommandBuffer cmdBuffer, VkImage image, VkImageAspectFlags aspectFlags, ResourceAccess from, ResourceAccess to, uint32_t baseMipLevel = 0, uint32_t mipLevelCount = 1);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Per frame graph of passes. Passes declare every resource they touch and how; Execute
+// drops passes whose results nobody consumes, then records the rest in order with the
+// barriers between them merged into one vkCmdPipelineBarrier2 per pass. Read after read in
+// the same layout costs nothing, and a layout is only ever changed when a pass needs it.
+// Rebuilt every frame, Reset keeps the allocations. With a profiler, every pass is a GPU
+// timing scope of its name, its barriers included.
+class RenderGraph {
+public:
+    using Resource = uint32_t;
+    using RecordFn = std::function<void(VkCommandBuffer cmdBuffer)>;
+
+    void     Reset();
+
+    // resources are owned elsewhere and come in with the state their last user left them in
+    Resource ImportImage(VkImage image, VkImageAspectFlags aspectFlags, ResourceAccess current, uint32_t mipLevels = 1);
+    Resource ImportBuffer(VkBuffer buffer, ResourceAccess current);
+
+    // contents discarded at first use (transient or aliased memory): the layout starts over
+    // from UNDEFINED, ordered after whatever last used the memory
+    Resource ImportTransientImage(VkImage image, VkImageAspectFlags aspectFlags, ResourceAccess previous);
+
+    // state the resource is left in after the graph; passes it depends on are never culled
+    void     Export(Resource resource, ResourceAccess final);
+
+    uint32_t AddPass(const char* name, RecordFn record);
+    void     Use(uint32_t pass, Resource resource, ResourceAccess access);
+
+    void     Execute(VkCommandBuffer cmdBuffer, GpuProfiler* profiler = nullptr);
+
+    // of the last Execute
+    uint32_t CulledPassCount() const { return culledPassCount; }
+    uint32_t BarrierCount() const { return barrierCount; }
+
+private:
+    struct ResourceState {
+        VkImage               image        = VK_NULL_HANDLE;    // null for buffers
+        VkBuffer              buffer       = VK_NULL_HANDLE;
+        VkImageAspectFlags    aspectFlags  = 0;
+        uint32_t              mipLevels    = 1;
+
+        VkImageLayout         layout       = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 writeStages  = VK_PIPELINE_STAGE_2_NONE;   // last write or layout change
+        VkAccessFlags2        writeAccess  = VK_ACCESS_2_NONE;
+        VkPipelineStageFlags2 readStages   = VK_PIPELINE_STAGE_2_NONE;   // reads since, already ordered after it
+
+        bool                  exported     = false;
+        ResourceAccess        final        = ResourceAccess::None;
+    };
+
+    struct Usage {
+        Resource   resource;
+        AccessInfo info;
+    };
+
+    struct Pass {
+        const char*        name;
+        RecordFn           record;
+        std::vector<Usage> usages;
+        bool               alive;
+    };
+
+    // the barrier taking the resource to info, if one is needed; batched by the caller
+    void Transition(ResourceState& state, const AccessInfo& info);
+    void FlushBarriers(VkCommandBuffer cmdBuffer);
+
+    std::vector<ResourceState> resources;
+    std::vector<bool>          needed;      // per resource, while culling
+    std::vector<Pass>          passes;
+    uint32_t                   passCount = 0;   // passes above are kept for their allocations
+
+    std::vector<VkImageMemoryBarrier2> imageBarriers;
+    VkMemoryBarrier2                   memoryBarrier {};
+
+    uint32_t culledPassCount = 0;
+    uint32_t barrierCount    = 0;
+};
@@ -0,0 +1,121 @@
+#include "ResizeStorm.h"
+
+#include <iomanip>
+
+namespace {
+
+// window sizes cycled through, landscape and portrait, some not a multiple of anything
+constexpr uint32_t SIZES[][2] = {
+    { 1280,  720 },
+    { 1920, 1080 },
+    {  801,  599 },
+    { 1600,  900 },
+    {  640, 1024 },
+    { 1366,  768 },
+    {  333,  257 },
+};
+
+constexpr uint32_t SIZE_COUNT = sizeof(SIZES) / sizeof(SIZES[0]);
+
+double Mib(uint64_t bytes) {
+    return double(bytes) / double(1 << 20);
+}
+
+// signed, a sample may also come out lower
+double GrowthMib(uint64_t before, uint64_t after) {
+    return Mib(after) - Mib(before);
+}
+
+}
+
+ResizeStorm::ResizeStorm(uint32_t resizes, uint32_t drainFrames)
+    : warmupResizes(2 * SIZE_COUNT)
+    , stormResizes(resizes)
+    , drainFrames(drainFrames) {
+}
+
+ResizeStorm::Action ResizeStorm::Step(bool settled, uint32_t& width, uint32_t& height) {
+    switch (phase) {
+        case Phase::Warmup:
+        case Phase::Storm:
+        {
+            const uint32_t target = phase == Phase::Warmup ? warmupResizes : stormResizes;
+
+            if (resizes < target) {
+                width  = SIZES[sizeIndex][0];
+                height = SIZES[sizeIndex][1];
+
+                sizeIndex = (sizeIndex + 1) % SIZE_COUNT;
+                resizes++;
+
+                return Action::Resize;
+            }
+
+            phase   = phase == Phase::Warmup ? Phase::DrainBaseline : Phase::DrainFinal;
+            drained = 0;
+            return Action::None;
+        }
+
+        case Phase::DrainBaseline:
+        case Phase::DrainFinal:
+            // the frame count only starts once loads are done, their memory is not ours
+            if (!settled) {
+                drained = 0;
+                return Action::None;
+            }
+
+            return ++drained > drainFrames ? Action::Sample : Action::None;
+
+        case Phase::Done:
+            break;
+    }
+
+    return Action::None;
+}
+
+void ResizeStorm::Record(const Sample& sample) {
+    if (phase == Phase::DrainBaseline) {
+        baseline = sample;
+        phase    = Phase::Storm;
+        resizes  = 0;
+    }
+    else if (phase == Phase::DrainFinal) {
+        after = sample;
+        phase = Phase::Done;
+    }
+}
+
+bool ResizeStorm::Passed() const {
+    if (phase != Phase::Done) {
+        return false;
+    }
+
+    return after.hostBytes      <= baseline.hostBytes + HOST_TOLERANCE
+        && after.deviceBytes    <= baseline.deviceBytes + DEVICE_TOLERANCE
+        && after.pendingRetires <= baseline.pendingRetires;
+}
+
+void ResizeStorm::Print(std::ostream& out) const {
+    out << "Resize storm: " << warmupResizes << " warmup, " << stormResizes << " measured resizes";
+
+    if (phase != Phase::Done) {
+        out << ", ended early" << std::endl;
+        return;
+    }
+
+    out << '\n' << std::fixed << std::setprecision(2);
+
+    out << "  host    " << Mib(baseline.hostBytes) << " MiB -> " << Mib(after.hostBytes) << " MiB ("
+        << std::showpos << GrowthMib(baseline.hostBytes, after.hostBytes) << std::noshowpos << ")\n";
+
+    if (baseline.deviceBytes || after.deviceBytes) {
+        out << "  device  " << Mib(baseline.deviceBytes) << " MiB -> " << Mib(after.deviceBytes) << " MiB ("
+            << std::showpos << GrowthMib(baseline.deviceBytes, after.deviceBytes) << std::noshowpos << ")\n";
+    }
+    else {
+        out << "  device  not known without VK_EXT_memory_budget\n";
+    }
+
+    out << "  retires " << baseline.pendingRetires << " -> " << after.pendingRetires << " pending\n";
+    out << "  " << (Passed() ? "flat" : "GROWN") << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// A stress run for swapchain recreation: the window is resized every frame through a cycle
+// of sizes while rendering goes on. Memory is sampled twice with the queues drained, once
+// after warmup resizes that let every buffer grow to the largest size, and once after the
+// storm; it passes when neither process nor device memory has grown past a tolerance and
+// nothing is left waiting to be retired beyond what the baseline had.
+class ResizeStorm {
+public:
+    struct Sample {
+        uint64_t hostBytes;         // private bytes of the process
+        uint64_t deviceBytes;       // in use on every heap, 0: not known
+        size_t   pendingRetires;
+    };
+
+    enum class Action {
+        None,
+        Resize,         // set the window to the size returned
+        Sample,         // drained, Record a sample now
+    };
+
+    // drainFrames: frames rendered without resizing before a sample, enough for every
+    // slot's fence to have been waited on
+    ResizeStorm(uint32_t resizes, uint32_t drainFrames);
+
+    // once a frame, before rendering; settled: no texture loads or uploads in flight, so
+    // a sample only sees what resizing allocates
+    Action Step(bool settled, uint32_t& width, uint32_t& height);
+    void   Record(const Sample& sample);
+
+    bool   Done() const { return phase == Phase::Done; }
+    bool   Passed() const;
+
+    void   Print(std::ostream& out) const;
+
+private:
+    enum class Phase {
+        Warmup,
+        DrainBaseline,
+        Storm,
+        DrainFinal,
+        Done,
+    };
+
+    static constexpr uint64_t HOST_TOLERANCE   = 8ull << 20;    // heap and driver caches settle
+    static constexpr uint64_t DEVICE_TOLERANCE = 4ull << 20;
+
+    Phase    phase         = Phase::Warmup;
+    uint32_t warmupResizes;
+    uint32_t stormResizes;
+    uint32_t drainFrames;
+
+    uint32_t resizes       = 0;     // in the current phase
+    uint32_t drained       = 0;
+    uint32_t sizeIndex     = 0;
+
+    Sample   baseline      = {};
+    Sample   after         = {};
+};
@@ -0,0 +1,63 @@
+#include "ResolutionScaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// aim below the budget, so noise doesn't flip between scales
+const float    HEADROOM       = 0.9f;
+const float    MAX_GROW_STEP  = 0.05f;
+const float    QUANTUM        = 1.0f / 64.0f;
+const float    SMOOTHING      = 0.2f;
+const uint32_t SETTLE_FRAMES  = 30;
+
+}
+
+ResolutionScaler::ResolutionScaler(float budgetMs, float minScale, float maxScale)
+    : budgetMs(budgetMs)
+    , minScale(minScale)
+    , maxScale(maxScale)
+    , scale(maxScale) {
+}
+
+float ResolutionScaler::Update(float gpuMs, float frameScale) {
+    if (frameScale != scale || gpuMs <= 0.0f) {
+        return scale;
+    }
+
+    filteredMs = (filteredMs == 0.0f) ? gpuMs : filteredMs + SMOOTHING * (gpuMs - filteredMs);
+    settled++;
+
+    const float target = budgetMs * HEADROOM;
+
+    // spikes are answered by the raw time, recoveries only by the average
+    const float worst = std::max(gpuMs, filteredMs);
+
+    if (worst > budgetMs) {
+        SetScale(scale * std::sqrt(target / worst));
+    }
+    else if (filteredMs < target && settled >= SETTLE_FRAMES) {
+        SetScale(std::min(scale * std::sqrt(target / filteredMs), scale + MAX_GROW_STEP));
+    }
+
+    return scale;
+}
+
+uint32_t ResolutionScaler::Scaled(uint32_t size, float scale) {
+    return std::max(1u, static_cast<uint32_t>(size * scale + 0.5f));
+}
+
+void ResolutionScaler::SetScale(float newScale) {
+    // down rounds down and up rounds up, so a change is never swallowed by the quantization
+    newScale = (newScale < scale) ? std::floor(newScale / QUANTUM) * QUANTUM : std::ceil(newScale / QUANTUM) * QUANTUM;
+    newScale = std::clamp(newScale, minScale, maxScale);
+
+    if (newScale == scale) {
+        return;
+    }
+
+    scale      = newScale;
+    filteredMs = 0.0f;
+    settled    = 0;
+}
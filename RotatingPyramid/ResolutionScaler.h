@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// Picks the render resolution scale from measured GPU frame times. Cost is taken to grow
+// with the pixel count (scale squared). Over budget, the scale drops at once to what the
+// measurement says fits; with enough headroom it creeps back up, a step at a time, after
+// a settling period. Scales are quantized so the target size doesn't change every frame.
+class ResolutionScaler {
+public:
+    ResolutionScaler(float budgetMs, float minScale, float maxScale = 1.0f);
+
+    // a finished frame's GPU time and the scale it was rendered at; measurements of frames
+    // from before the last change are ignored. Returns the scale for the next frame.
+    float Update(float gpuMs, float frameScale);
+
+    float Scale() const { return scale; }
+    float FilteredMs() const { return filteredMs; }
+
+    // a dimension at a scale, never below one pixel
+    static uint32_t Scaled(uint32_t size, float scale);
+
+private:
+    void  SetScale(float newScale);
+
+    float    budgetMs;
+    float    minScale;
+    float    maxScale;
+
+    float    scale       = 1.0f;
+    float    filteredMs  = 0.0f;    // moving average at the current scale, 0 until measured
+    uint32_t settled     = 0;       // frames measured since the last change
+};
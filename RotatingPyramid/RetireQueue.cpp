@@ -0,0 +1,113 @@
+#include "RetireQueue.h"
+
+namespace {
+
+// pointers on 64 bit targets, uint64_t on 32 bit ones
+template<typename Handle>
+uint64_t HandleBits(Handle handle) {
+    return (uint64_t)handle;
+}
+
+template<typename Handle>
+Handle FromBits(uint64_t bits) {
+    return (Handle)bits;
+}
+
+}
+
+void RetireQueue::Create(VkDevice dev, uint32_t slotCount, uint32_t reservePerSlot) {
+    device = dev;
+    slots.resize(slotCount);
+
+    for (auto& slot : slots) {
+        slot.reserve(reservePerSlot);
+    }
+}
+
+void RetireQueue::RetireBuffer(uint32_t slot, uint64_t frame, VkBuffer buffer) {
+    Push(slot, Kind::Buffer, HandleBits(buffer), frame);
+}
+
+void RetireQueue::RetireImage(uint32_t slot, uint64_t frame, VkImage image) {
+    Push(slot, Kind::Image, HandleBits(image), frame);
+}
+
+void RetireQueue::RetireImageView(uint32_t slot, uint64_t frame, VkImageView view) {
+    Push(slot, Kind::ImageView, HandleBits(view), frame);
+}
+
+void RetireQueue::RetireMemory(uint32_t slot, uint64_t frame, VkDeviceMemory memory) {
+    Push(slot, Kind::Memory, HandleBits(memory), frame);
+}
+
+void RetireQueue::RetireSwapchain(uint32_t slot, uint64_t frame, VkSwapchainKHR swapchain) {
+    Push(slot, Kind::Swapchain, HandleBits(swapchain), frame);
+}
+
+void RetireQueue::Push(uint32_t slot, Kind kind, uint64_t handle, uint64_t frame) {
+    if (handle == 0) {
+        return;
+    }
+
+    slots[slot].push_back({ kind, handle, frame });
+}
+
+void RetireQueue::Collect(uint32_t slot, uint64_t completedFrames) {
+    std::vector<Record>& records = slots[slot];
+
+    // in retire order; records of frames not yet finished (never submitted) stay, in order
+    size_t kept = 0;
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i].frame < completedFrames) {
+            Destroy(records[i]);
+        }
+        else {
+            records[kept++] = records[i];
+        }
+    }
+
+    records.resize(kept);
+}
+
+void RetireQueue::Flush() {
+    for (auto& records : slots) {
+        for (const Record& record : records) {
+            Destroy(record);
+        }
+
+        records.clear();
+    }
+}
+
+size_t RetireQueue::PendingCount() const {
+    size_t count = 0;
+
+    for (const auto& records : slots) {
+        count += records.size();
+    }
+
+    return count;
+}
+
+void RetireQueue::Destroy(const Record& record) const {
+    switch (record.kind) {
+        case Kind::Buffer:
+            vkDestroyBuffer(device, FromBits<VkBuffer>(record.handle), nullptr);
+            break;
+        case Kind::Image:
+            vkDestroyImage(device, FromBits<VkImage>(record.handle), nullptr);
+            break;
+        case Kind::ImageView:
+            vkDestroyImageView(device, FromBits<VkImageView>(record.handle), nullptr);
+            break;
+        case Kind::Memory:
+            // unmaps, if mapped
+            vkFreeMemory(device, FromBits<VkDeviceMemory>(record.handle), nullptr);
+            break;
+        case Kind::Swapchain:
+            // its images go with it
+            vkDestroySwapchainKHR(device, FromBits<VkSwapchainKHR>(record.handle), nullptr);
+            break;
+    }
+}
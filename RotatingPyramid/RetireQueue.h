@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Vulkan objects let go of while frames that may still use them are on the GPU. Each is
+// stamped with the number of the frame being recorded when it was retired and kept in the
+// queue of that frame's slot; Collect destroys it once the slot's fence shows that frame
+// has finished. Records are typed handles in storage reserved up front, so retiring in a
+// steady state allocates nothing and never waits. DeletionQueue remains for teardown at exit.
+class RetireQueue {
+public:
+    void Create(VkDevice device, uint32_t slotCount, uint32_t reservePerSlot = 64);
+
+    // frame: the one being recorded (frames submitted so far); objects that depend on each
+    // other are retired users first (view, then image, then memory; views, then their swapchain). Separate names, as
+    // non-dispatchable handles are all uint64_t on 32 bit targets.
+    void RetireBuffer(uint32_t slot, uint64_t frame, VkBuffer buffer);
+    void RetireImage(uint32_t slot, uint64_t frame, VkImage image);
+    void RetireImageView(uint32_t slot, uint64_t frame, VkImageView view);
+    void RetireMemory(uint32_t slot, uint64_t frame, VkDeviceMemory memory);
+    void RetireSwapchain(uint32_t slot, uint64_t frame, VkSwapchainKHR swapchain);
+
+    // the slot's fence has signalled: every frame before completedFrames is done
+    void Collect(uint32_t slot, uint64_t completedFrames);
+
+    // device idle: destroys everything left
+    void Flush();
+
+    size_t PendingCount() const;
+
+private:
+    enum class Kind : uint8_t {
+        Buffer,
+        Image,
+        ImageView,
+        Memory,
+        Swapchain,
+    };
+
+    struct Record {
+        Kind     kind;
+        uint64_t handle;    // non-dispatchable handles are 64 bit everywhere
+        uint64_t frame;
+    };
+
+    void Push(uint32_t slot, Kind kind, uint64_t handle, uint64_t frame);
+    void Destroy(const Record& record) const;
+
+    VkDevice                         device = VK_NULL_HANDLE;
+    std::vector<std::vector<Record>> slots;
+};
@@ -0,0 +1,246 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+Scene::NodeId Scene::AddNode(NodeId parent, const Transform& local) {
+    uint32_t parentSlot = NO_PARENT;
+
+    if (parent != INVALID_NODE) {
+        if (parent >= handleToSlot.size()) {
+            throw std::runtime_error("Scene node parent does not exist!");
+        }
+
+        parentSlot = handleToSlot[parent];
+    }
+
+    uint32_t slot   = static_cast<uint32_t>(parentVec.size());
+    NodeId   handle = static_cast<NodeId>(handleToSlot.size());
+
+    // appending keeps depth first order only if the parent's subtree currently ends at the back,
+    // which is the common case when a hierarchy is loaded top down
+    bool keepsOrder = (parentSlot == NO_PARENT) || (parentSlot + subtreeSizeVec[parentSlot] == slot);
+
+    if (keepsOrder && !hierarchyDirty) {
+        for (uint32_t p = parentSlot; p != NO_PARENT; p = parentVec[p]) {
+            subtreeSizeVec[p]++;
+        }
+    }
+    else {
+        hierarchyDirty = true;
+    }
+
+    parentVec.push_back(parentSlot);
+    subtreeSizeVec.push_back(1);
+    dirtyVec.push_back(1);
+    localVec.push_back(local);
+    localMatrixVec.emplace_back(1.0f);
+    worldVec.emplace_back(1.0f);
+    slotToHandle.push_back(handle);
+    handleToSlot.push_back(slot);
+
+    dirtyHandles.push_back(handle);
+
+    return handle;
+}
+
+Scene::NodeId Scene::AddNode(NodeId parent) {
+    return AddNode(parent, Transform{});
+}
+
+void Scene::SetLocalTransform(NodeId node, const Transform& local) {
+    uint32_t slot = handleToSlot[node];
+
+    localVec[slot] = local;
+
+    if (!dirtyVec[slot]) {
+        dirtyVec[slot] = 1;
+        dirtyHandles.push_back(node);
+    }
+}
+
+Scene::NodeId Scene::GetParent(NodeId node) const {
+    uint32_t parentSlot = parentVec[handleToSlot[node]];
+
+    return parentSlot == NO_PARENT ? INVALID_NODE : slotToHandle[parentSlot];
+}
+
+uint32_t Scene::UpdateTransforms() {
+    if (hierarchyDirty) {
+        SortHierarchy();
+    }
+
+    if (dirtyHandles.empty()) {
+        return 0;
+    }
+
+    dirtySlots.clear();
+    for (NodeId h : dirtyHandles) {
+        dirtySlots.push_back(handleToSlot[h]);
+    }
+
+    dirtyHandles.clear();
+
+    // ascending slots visit ancestors before descendants, a dirty node inside an already
+    // refreshed subtree is skipped as its range was covered by the ancestor walk
+    std::sort(dirtySlots.begin(), dirtySlots.end());
+
+    uint32_t touched    = 0;
+    uint32_t coveredEnd = 0;
+
+    for (uint32_t root : dirtySlots) {
+        if (root < coveredEnd) {
+            continue;
+        }
+
+        uint32_t end = root + subtreeSizeVec[root];
+
+        for (uint32_t i = root; i < end; ++i) {
+            if (dirtyVec[i]) {
+                localMatrixVec[i] = ComposeMatrix(localVec[i]);
+                dirtyVec[i] = 0;
+            }
+
+            uint32_t p = parentVec[i];
+            worldVec[i] = (p == NO_PARENT) ? localMatrixVec[i] : worldVec[p] * localMatrixVec[i];
+        }
+
+        touched   += end - root;
+        coveredEnd = end;
+    }
+
+    if (touched) {
+        version++;
+    }
+
+    return touched;
+}
+
+void Scene::Reserve(size_t count) {
+    parentVec.reserve(count);
+    subtreeSizeVec.reserve(count);
+    dirtyVec.reserve(count);
+    localVec.reserve(count);
+    localMatrixVec.reserve(count);
+    worldVec.reserve(count);
+    slotToHandle.reserve(count);
+    handleToSlot.reserve(count);
+    dirtyHandles.reserve(count);
+    dirtySlots.reserve(count);
+}
+
+void Scene::Clear() {
+    parentVec.clear();
+    subtreeSizeVec.clear();
+    dirtyVec.clear();
+    localVec.clear();
+    localMatrixVec.clear();
+    worldVec.clear();
+    slotToHandle.clear();
+    handleToSlot.clear();
+    dirtyHandles.clear();
+    dirtySlots.clear();
+
+    hierarchyDirty = false;
+    version++;
+}
+
+void Scene::SortHierarchy() {
+    const uint32_t count = static_cast<uint32_t>(parentVec.size());
+
+    // children of every slot in a flat array (counting sort on the parent slot),
+    // roots are bucketed under the extra entry at index count
+    std::vector<uint32_t> childStart(count + 2, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t p = parentVec[i] == NO_PARENT ? count : parentVec[i];
+        childStart[p + 1]++;
+    }
+
+    for (uint32_t i = 0; i < count + 1; ++i) {
+        childStart[i + 1] += childStart[i];
+    }
+
+    std::vector<uint32_t> children(count);
+    {
+        std::vector<uint32_t> cursor(childStart.begin(), childStart.end() - 1);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t p = parentVec[i] == NO_PARENT ? count : parentVec[i];
+            children[cursor[p]++] = i;
+        }
+    }
+
+    // iterative pre-order walk, children pushed in reverse so they pop in insertion order
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> stack;
+
+    order.reserve(count);
+    stack.reserve(count);
+
+    for (uint32_t c = childStart[count + 1]; c-- > childStart[count]; ) {
+        stack.push_back(children[c]);
+    }
+
+    while (!stack.empty()) {
+        uint32_t slot = stack.back();
+        stack.pop_back();
+
+        order.push_back(slot);
+
+        for (uint32_t c = childStart[slot + 1]; c-- > childStart[slot]; ) {
+            stack.push_back(children[c]);
+        }
+    }
+
+    std::vector<uint32_t> oldToNew(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        oldToNew[order[i]] = i;
+    }
+
+    auto permute = [&](auto& vec) {
+        std::remove_reference_t<decltype(vec)> sorted(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            sorted[i] = vec[order[i]];
+        }
+        vec.swap(sorted);
+    };
+
+    permute(dirtyVec);
+    permute(localVec);
+    permute(localMatrixVec);
+    permute(worldVec);
+    permute(slotToHandle);
+
+    std::vector<uint32_t> parents(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t p = parentVec[order[i]];
+        parents[i] = (p == NO_PARENT) ? NO_PARENT : oldToNew[p];
+    }
+    parentVec.swap(parents);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        handleToSlot[slotToHandle[i]] = i;
+    }
+
+    // children come after their parents, accumulate sizes back to front
+    std::fill(subtreeSizeVec.begin(), subtreeSizeVec.end(), 1);
+    for (uint32_t i = count; i-- > 0; ) {
+        if (parentVec[i] != NO_PARENT) {
+            subtreeSizeVec[parentVec[i]] += subtreeSizeVec[i];
+        }
+    }
+
+    hierarchyDirty = false;
+}
+
+glm::mat4 Scene::ComposeMatrix(const Transform& t) {
+    // T * R * S without going through three full matrix products
+    glm::mat4 m = glm::mat4_cast(t.rotation);
+
+    m[0] *= t.scale.x;
+    m[1] *= t.scale.y;
+    m[2] *= t.scale.z;
+    m[3]  = glm::vec4(t.translation, 1.0f);
+
+    return m;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Data oriented scene store.
+//
+// Nodes live in flat parallel arrays (SoA) kept in depth-first order, so a parent
+// always precedes its children and a whole subtree is the contiguous slot range
+// [slot, slot + subtreeSize[slot]). NodeIds handed out to callers are stable; slots
+// are an internal detail and change whenever the hierarchy is re-sorted.
+//
+// UpdateTransforms() walks only the subtrees below nodes touched since the last
+// update, so a mostly static scene costs next to nothing per frame.
+class Scene {
+public:
+    using NodeId = uint32_t;
+
+    static constexpr NodeId INVALID_NODE = UINT32_MAX;
+
+    struct Transform {
+        glm::vec3 translation { 0.0f, 0.0f, 0.0f };
+        glm::quat rotation    { 1.0f, 0.0f, 0.0f, 0.0f };   // w, x, y, z
+        glm::vec3 scale       { 1.0f, 1.0f, 1.0f };
+    };
+
+    // parent must be INVALID_NODE (root) or an existing node
+    NodeId AddNode(NodeId parent, const Transform& local);
+    NodeId AddNode(NodeId parent);
+
+    void SetLocalTransform(NodeId node, const Transform& local);
+
+    const Transform& GetLocalTransform(NodeId node) const { return localVec[handleToSlot[node]]; }
+    const glm::mat4& GetWorldMatrix(NodeId node) const    { return worldVec[handleToSlot[node]]; }
+    NodeId           GetParent(NodeId node) const;
+
+    size_t   NodeCount() const { return parentVec.size(); }
+
+    // bumped every time at least one world matrix changes
+    uint64_t Version() const   { return version; }
+
+    // recomputes world matrices of dirty subtrees, returns number of nodes touched
+    uint32_t UpdateTransforms();
+
+    void Reserve(size_t count);
+    void Clear();
+
+private:
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    void SortHierarchy();
+
+    static glm::mat4 ComposeMatrix(const Transform& t);
+
+    // per slot, all arrays share the same indexing
+    std::vector<uint32_t>   parentVec;          // parent slot or NO_PARENT
+    std::vector<uint32_t>   subtreeSizeVec;     // node itself + all descendants
+    std::vector<uint8_t>    dirtyVec;
+    std::vector<Transform>  localVec;
+    std::vector<glm::mat4>  localMatrixVec;
+    std::vector<glm::mat4>  worldVec;
+    std::vector<NodeId>     slotToHandle;
+
+    // per handle
+    std::vector<uint32_t>   handleToSlot;
+
+    // handles touched since last update
+    std::vector<NodeId>     dirtyHandles;
+    std::vector<uint32_t>   dirtySlots;
+
+    bool                    hierarchyDirty = false;
+    uint64_t                version        = 0;
+};
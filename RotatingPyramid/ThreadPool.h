@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CpuProfiler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Fixed set of worker threads draining one FIFO of jobs. Jobs report their own results and
+// must not throw; jobs still queued at destruction are dropped, running ones finish.
+class ThreadPool {
+public:
+    using Job = std::function<void()>;
+
+    explicit ThreadPool(uint32_t threadCount = DefaultThreadCount()) {
+        for (uint32_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            jobs.clear();
+        }
+
+        wake.notify_all();
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+
+        wake.notify_one();
+    }
+
+    // blocks until the queue is empty and no job is running
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return jobs.empty() && running == 0; });
+    }
+
+    uint32_t ThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    // leave one core to the render thread
+    static uint32_t DefaultThreadCount() {
+        return std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+private:
+    void WorkerLoop() {
+        CPU_THREAD_NAME("worker");
+
+        for (;;) {
+            Job job;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+                if (stopping) {
+                    return;
+                }
+
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                running++;
+            }
+
+            {
+                CPU_ZONE("job");
+                job();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running--;
+            }
+
+            idle.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<Job>          jobs;
+    std::mutex               mutex;
+    std::condition_variable  wake;
+    std::condition_variable  idle;
+    uint32_t                 running  = 0;
+    bool                     stopping = false;
+};
@@ -0,0 +1,58 @@
+#include "TransientMemory.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool LifetimesOverlap(const TransientMemory::Block& a, const TransientMemory::Block& b) {
+    return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+}
+
+}
+
+uint64_t TransientMemory::Place(const std::vector<Block>& blocks, std::vector<uint64_t>& offsets) {
+    offsets.assign(blocks.size(), 0);
+
+    std::vector<size_t> order(blocks.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return blocks[a].size > blocks[b].size; });
+
+    std::vector<size_t> placed;
+    std::vector<size_t> live;
+    uint64_t            total = 0;
+
+    for (size_t i : order) {
+        const Block& block = blocks[i];
+
+        // byte ranges of already placed blocks alive at the same time, lowest first
+        live.clear();
+        for (size_t p : placed) {
+            if (LifetimesOverlap(block, blocks[p])) {
+                live.push_back(p);
+            }
+        }
+
+        std::sort(live.begin(), live.end(), [&](size_t a, size_t b) { return offsets[a] < offsets[b]; });
+
+        uint64_t offset = 0;
+        for (size_t p : live) {
+            if (offset + block.size <= offsets[p]) {
+                break;
+            }
+
+            offset = std::max(offset, AlignUp(offsets[p] + blocks[p].size, block.alignment));
+        }
+
+        offsets[i] = offset;
+        total      = std::max(total, offset + block.size);
+
+        placed.push_back(i);
+    }
+
+    return total;
+}
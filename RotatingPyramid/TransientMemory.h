@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Packs attachments that only live for part of a frame into one allocation. Lifetimes are
+// inclusive ranges of graph pass indices; blocks whose lifetimes overlap never share bytes,
+// all others may. Largest blocks are placed first, each at the lowest aligned offset that
+// is free for its whole lifetime.
+class TransientMemory {
+public:
+    struct Block {
+        uint64_t size;
+        uint64_t alignment;
+        uint32_t firstPass;
+        uint32_t lastPass;
+    };
+
+    // byte offset of every block; returns the size of the allocation they need
+    static uint64_t Place(const std::vector<Block>& blocks, std::vector<uint64_t>& offsets);
+};
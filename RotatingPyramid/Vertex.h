@@ -0,0 +1,19 @@
+#pragma once
+
+#include "VertexLayout.h"
+
+// CPU side vertex, what loaders and mesh processing work on. The GPU copy is split into
+// streams, see FloatVertexLayout.
+struct Vertex {
+    float position[3];
+    float color[3];
+    float texCoord[2];
+};
+
+using FloatVertexLayout = VertexLayout<
+    VertexAttribute<0, VERTEX_STREAM_POSITION,   VK_FORMAT_R32G32B32_SFLOAT, sizeof(Vertex::position)>,
+    VertexAttribute<1, VERTEX_STREAM_ATTRIBUTES, VK_FORMAT_R32G32B32_SFLOAT, sizeof(Vertex::color)>,
+    VertexAttribute<2, VERTEX_STREAM_ATTRIBUTES, VK_FORMAT_R32G32_SFLOAT,    sizeof(Vertex::texCoord)>>;
+
+static_assert(FloatVertexLayout::Stride(VERTEX_STREAM_POSITION) == 12, "Float position stream is 12 bytes");
+static_assert(FloatVertexLayout::Stride(VERTEX_STREAM_ATTRIBUTES) == 20, "Float attribute stream is 20 bytes");
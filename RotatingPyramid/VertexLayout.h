@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// vertex buffer bindings; positions get a stream of their own so depth only passes
+// fetch nothing else
+enum VertexStream : uint32_t {
+    VERTEX_STREAM_POSITION   = 0,
+    VERTEX_STREAM_ATTRIBUTES = 1,
+};
+
+// one shader input: location, the stream it is fetched from, format and size in bytes
+template <uint32_t Location, uint32_t Stream, VkFormat Format, uint32_t Size>
+struct VertexAttribute {
+    static constexpr uint32_t location = Location;
+    static constexpr uint32_t stream   = Stream;
+    static constexpr VkFormat format   = Format;
+    static constexpr uint32_t size     = Size;
+};
+
+// Runtime copy of a VertexLayout, for when the layout is picked per mesh at load time.
+struct VertexInputDescription {
+    static constexpr uint32_t MAX_STREAMS    = 4;
+    static constexpr uint32_t MAX_ATTRIBUTES = 8;
+
+    uint32_t bindingCount   = 0;
+    uint32_t attributeCount = 0;
+
+    std::array<VkVertexInputBindingDescription, MAX_STREAMS>      bindings{};
+    std::array<VkVertexInputAttributeDescription, MAX_ATTRIBUTES> attributes{};
+    std::array<uint32_t, MAX_ATTRIBUTES>                          sizes{};
+
+    // bytes per vertex over all streams
+    uint32_t VertexSize() const {
+        uint32_t size = 0;
+        for (uint32_t i = 0; i < bindingCount; ++i) {
+            size += bindings[i].stride;
+        }
+        return size;
+    }
+
+    // keeps the first streamCount streams and the attributes read from them
+    VertexInputDescription Streams(uint32_t streamCount) const {
+        VertexInputDescription out;
+
+        out.bindingCount = std::min(streamCount, bindingCount);
+        for (uint32_t i = 0; i < out.bindingCount; ++i) {
+            out.bindings[i] = bindings[i];
+        }
+
+        for (uint32_t i = 0; i < attributeCount; ++i) {
+            if (attributes[i].binding < out.bindingCount) {
+                out.attributes[out.attributeCount] = attributes[i];
+                out.sizes[out.attributeCount]      = sizes[i];
+                out.attributeCount++;
+            }
+        }
+
+        return out;
+    }
+};
+
+// Binding and attribute descriptions generated at compile time from a list of
+// VertexAttribute. Attributes are packed in list order within their stream and every
+// stream becomes one binding whose stride is the sum of its attributes.
+template <typename... Attributes>
+struct VertexLayout {
+    static_assert(sizeof...(Attributes) > 0, "VertexLayout needs at least one attribute");
+
+    static constexpr uint32_t ATTRIBUTE_COUNT = sizeof...(Attributes);
+    static constexpr uint32_t STREAM_COUNT    = std::max({ Attributes::stream... }) + 1;
+
+    static_assert(ATTRIBUTE_COUNT <= VertexInputDescription::MAX_ATTRIBUTES, "Too many vertex attributes");
+    static_assert(STREAM_COUNT <= VertexInputDescription::MAX_STREAMS, "Too many vertex streams");
+
+    static constexpr std::array<uint32_t, ATTRIBUTE_COUNT> locations = { Attributes::location... };
+    static constexpr std::array<uint32_t, ATTRIBUTE_COUNT> streams   = { Attributes::stream... };
+    static constexpr std::array<VkFormat, ATTRIBUTE_COUNT> formats   = { Attributes::format... };
+    static constexpr std::array<uint32_t, ATTRIBUTE_COUNT> sizes     = { Attributes::size... };
+
+    static constexpr uint32_t Offset(uint32_t attribute) {
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < attribute; ++i) {
+            if (streams[i] == streams[attribute]) {
+                offset += sizes[i];
+            }
+        }
+        return offset;
+    }
+
+    static constexpr uint32_t Stride(uint32_t stream) {
+        uint32_t stride = 0;
+        for (uint32_t i = 0; i < ATTRIBUTE_COUNT; ++i) {
+            if (streams[i] == stream) {
+                stride += sizes[i];
+            }
+        }
+        return stride;
+    }
+
+    static constexpr uint32_t AttributeCount(uint32_t stream) {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < ATTRIBUTE_COUNT; ++i) {
+            count += (streams[i] == stream) ? 1 : 0;
+        }
+        return count;
+    }
+
+    static constexpr std::array<VkVertexInputBindingDescription, STREAM_COUNT> GetInputBindingDescriptionArray() {
+        std::array<VkVertexInputBindingDescription, STREAM_COUNT> val{};
+
+        for (uint32_t s = 0; s < STREAM_COUNT; ++s) {
+            val[s] = {
+                s, // binding
+                Stride(s), // stride
+                VK_VERTEX_INPUT_RATE_VERTEX // data is per vertex
+            };
+        }
+
+        return val;
+    }
+
+    static constexpr std::array<VkVertexInputAttributeDescription, ATTRIBUTE_COUNT> GetInputAttributeDescriptionArray() {
+        std::array<VkVertexInputAttributeDescription, ATTRIBUTE_COUNT> val{};
+
+        for (uint32_t i = 0; i < ATTRIBUTE_COUNT; ++i) {
+            val[i] = {
+                locations[i], // location
+                streams[i], // binding
+                formats[i],
+                Offset(i)
+            };
+        }
+
+        return val;
+    }
+
+    static constexpr VertexInputDescription Describe() {
+        VertexInputDescription desc;
+
+        auto bindings   = GetInputBindingDescriptionArray();
+        auto attributes = GetInputAttributeDescriptionArray();
+
+        desc.bindingCount   = STREAM_COUNT;
+        desc.attributeCount = ATTRIBUTE_COUNT;
+
+        for (uint32_t s = 0; s < STREAM_COUNT; ++s) {
+            desc.bindings[s] = bindings[s];
+        }
+
+        for (uint32_t i = 0; i < ATTRIBUTE_COUNT; ++i) {
+            desc.attributes[i] = attributes[i];
+            desc.sizes[i]      = sizes[i];
+        }
+
+        return desc;
+    }
+};
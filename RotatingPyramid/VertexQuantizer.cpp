@@ -0,0 +1,344 @@
+#include "VertexQuantizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region VertexEncoding
+
+VertexInputDescription VertexEncoding::GetInputDescription() const {
+    bool unormTexCoord = texCoordFormat == VK_FORMAT_R16G16_UNORM;
+
+    switch (positionFormat) {
+    case PositionFormat::Half:
+        return unormTexCoord
+            ? PackedVertexLayout<VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R16G16_UNORM>::Describe()
+            : PackedVertexLayout<VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R16G16_SFLOAT>::Describe();
+
+    case PositionFormat::Snorm16:
+        return unormTexCoord
+            ? PackedVertexLayout<VK_FORMAT_R16G16B16A16_SNORM, VK_FORMAT_R16G16_UNORM>::Describe()
+            : PackedVertexLayout<VK_FORMAT_R16G16B16A16_SNORM, VK_FORMAT_R16G16_SFLOAT>::Describe();
+
+    default:
+        return FloatVertexLayout::Describe();
+    }
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region Conversions
+
+uint16_t VertexQuantizer::FloatToHalf(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t absx = x & 0x7fffffff;
+
+    // inf / nan
+    if (absx >= 0x7f800000) {
+        return static_cast<uint16_t>(sign | (absx > 0x7f800000 ? 0x7e00 : 0x7c00));
+    }
+
+    // rounds to inf
+    if (absx >= 0x477ff000) {
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+
+    // half subnormal range, let the FPU do round to nearest even on the 2^-24 grid
+    if (absx < 0x38800000) {
+        float mag;
+        std::memcpy(&mag, &absx, sizeof(mag));
+        return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(mag * 16777216.0f)));
+    }
+
+    // rebias exponent, round to nearest even on the dropped 13 mantissa bits
+    uint32_t h   = (absx - 0x38000000) >> 13;
+    uint32_t rem = absx & 0x1fff;
+
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) {
+        h++;
+    }
+
+    return static_cast<uint16_t>(sign | h);
+}
+
+float VertexQuantizer::HalfToFloat(uint16_t h) {
+    uint32_t sign = uint32_t(h & 0x8000) << 16;
+    uint32_t exp  = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+
+    float out;
+
+    if (exp == 0) {
+        out = std::ldexp(float(mant), -24);
+        return sign ? -out : out;
+    }
+
+    uint32_t bits = (exp == 31)
+        ? (sign | 0x7f800000 | (mant << 13))
+        : (sign | ((exp + 112) << 23) | (mant << 13));
+
+    std::memcpy(&out, &bits, sizeof(out));
+    return out;
+}
+
+namespace {
+
+inline int16_t ToSnorm16(float v) {
+    return static_cast<int16_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+}
+
+inline float FromSnorm16(int16_t v) {
+    return std::max(float(v) / 32767.0f, -1.0f);
+}
+
+inline uint16_t ToUnorm16(float v) {
+    return static_cast<uint16_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 65535.0f));
+}
+
+inline uint8_t ToUnorm8(float v) {
+    return static_cast<uint8_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+}
+
+}
+
+PackedVertex VertexQuantizer::PackVertex(const Vertex& v, const VertexEncoding& enc) {
+    PackedVertex p{};
+
+    for (int c = 0; c < 3; ++c) {
+        float n = (v.position[c] - enc.positionBias[c]) / enc.positionScale[c];
+
+        if (enc.positionFormat == VertexEncoding::PositionFormat::Half) {
+            p.position[c] = FloatToHalf(n);
+        }
+        else {
+            int16_t s = ToSnorm16(n);
+            std::memcpy(&p.position[c], &s, sizeof(s));
+        }
+
+        p.color[c] = ToUnorm8(v.color[c]);
+    }
+
+    p.position[3] = enc.positionFormat == VertexEncoding::PositionFormat::Half ? FloatToHalf(1.0f) : 32767;
+    p.color[3]    = 255;
+
+    for (int c = 0; c < 2; ++c) {
+        p.texCoord[c] = enc.texCoordFormat == VK_FORMAT_R16G16_UNORM ? ToUnorm16(v.texCoord[c]) : FloatToHalf(v.texCoord[c]);
+    }
+
+    return p;
+}
+
+Vertex VertexQuantizer::UnpackVertex(const PackedVertex& p, const VertexEncoding& enc) {
+    Vertex v{};
+
+    for (int c = 0; c < 3; ++c) {
+        float n;
+
+        if (enc.positionFormat == VertexEncoding::PositionFormat::Half) {
+            n = HalfToFloat(p.position[c]);
+        }
+        else {
+            int16_t s;
+            std::memcpy(&s, &p.position[c], sizeof(s));
+            n = FromSnorm16(s);
+        }
+
+        v.position[c] = n * enc.positionScale[c] + enc.positionBias[c];
+        v.color[c]    = p.color[c] / 255.0f;
+    }
+
+    for (int c = 0; c < 2; ++c) {
+        v.texCoord[c] = enc.texCoordFormat == VK_FORMAT_R16G16_UNORM ? p.texCoord[c] / 65535.0f : HalfToFloat(p.texCoord[c]);
+    }
+
+    return v;
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region Selection
+
+VertexEncoding VertexQuantizer::Choose(const MeshData& mesh, Mode mode, float tolerance, ErrorReport* report) {
+    VertexEncoding floatEncoding;
+
+    auto finish = [&](const VertexEncoding& enc) {
+        if (report) {
+            *report = Measure(mesh, enc);
+        }
+        return enc;
+    };
+
+    if (mode == Mode::Float || mesh.vertices.empty()) {
+        return finish(floatEncoding);
+    }
+
+    VertexEncoding packed;
+
+    // normalize into [-1, 1] around the bounding box centre
+    for (int c = 0; c < 3; ++c) {
+        float halfExtent = 0.5f * (mesh.boundsMax[c] - mesh.boundsMin[c]);
+
+        packed.positionBias[c]  = 0.5f * (mesh.boundsMax[c] + mesh.boundsMin[c]);
+        packed.positionScale[c] = halfExtent > 0.0f ? halfExtent : 1.0f;
+    }
+
+    // unorm covers the usual [0, 1] atlas, tiling uvs need the half float range
+    bool uvInUnitRange = std::all_of(mesh.vertices.begin(), mesh.vertices.end(), [](const Vertex& v) {
+        return v.texCoord[0] >= 0.0f && v.texCoord[0] <= 1.0f && v.texCoord[1] >= 0.0f && v.texCoord[1] <= 1.0f;
+    });
+
+    packed.texCoordFormat = uvInUnitRange ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R16G16_SFLOAT;
+
+    if (mode == Mode::Half || mode == Mode::Snorm16) {
+        packed.positionFormat = (mode == Mode::Half) ? VertexEncoding::PositionFormat::Half : VertexEncoding::PositionFormat::Snorm16;
+        return finish(packed);
+    }
+
+    VertexEncoding best   = floatEncoding;
+    ErrorReport    bestErr{};
+    bool           found  = false;
+
+    for (auto fmt : { VertexEncoding::PositionFormat::Snorm16, VertexEncoding::PositionFormat::Half }) {
+        packed.positionFormat = fmt;
+
+        ErrorReport err = Measure(mesh, packed);
+        if (err.positionRelative <= tolerance && (!found || err.positionRelative < bestErr.positionRelative)) {
+            best    = packed;
+            bestErr = err;
+            found   = true;
+        }
+    }
+
+    if (!found) {
+        return finish(floatEncoding);
+    }
+
+    if (report) {
+        *report = bestErr;
+    }
+
+    return best;
+}
+
+VertexQuantizer::ErrorReport VertexQuantizer::Measure(const MeshData& mesh, const VertexEncoding& enc) {
+    ErrorReport err;
+
+    if (!enc.IsPacked() || mesh.vertices.empty()) {
+        return err;
+    }
+
+    double sumSq = 0.0;
+
+    for (const Vertex& v : mesh.vertices) {
+        Vertex r = UnpackVertex(PackVertex(v, enc), enc);
+
+        float d2 = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+            float d = r.position[c] - v.position[c];
+            d2 += d * d;
+
+            err.colorMax = std::max(err.colorMax, std::fabs(r.color[c] - std::clamp(v.color[c], 0.0f, 1.0f)));
+        }
+
+        for (int c = 0; c < 2; ++c) {
+            err.texCoordMax = std::max(err.texCoordMax, std::fabs(r.texCoord[c] - v.texCoord[c]));
+        }
+
+        err.positionMax = std::max(err.positionMax, std::sqrt(d2));
+        sumSq += d2;
+    }
+
+    float diagonal = 0.0f;
+    for (int c = 0; c < 3; ++c) {
+        float e = mesh.boundsMax[c] - mesh.boundsMin[c];
+        diagonal += e * e;
+    }
+    diagonal = std::sqrt(diagonal);
+
+    err.positionRms      = float(std::sqrt(sumSq / mesh.vertices.size()));
+    err.positionRelative = diagonal > 0.0f ? err.positionMax / diagonal : 0.0f;
+
+    return err;
+}
+
+void VertexQuantizer::PrintReport(const VertexEncoding& enc, const ErrorReport& err) {
+    static const char* names[] = { "float32", "half", "snorm16" };
+
+    VertexInputDescription desc = enc.GetInputDescription();
+
+    std::cout << "Vertex format: " << names[static_cast<int>(enc.positionFormat)] << " positions, "
+              << desc.VertexSize() << " bytes/vertex (" << desc.bindings[VERTEX_STREAM_POSITION].stride << " in the position stream)";
+
+    if (enc.IsPacked()) {
+        std::cout << " (uv " << (enc.texCoordFormat == VK_FORMAT_R16G16_UNORM ? "unorm16" : "half") << ")"
+                  << ", position error max " << err.positionMax << " rms " << err.positionRms
+                  << " (" << err.positionRelative * 100.0f << "% of diagonal)"
+                  << ", colour max " << err.colorMax << ", uv max " << err.texCoordMax;
+    }
+
+    std::cout << std::endl;
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region Streams
+
+VkDeviceSize VertexQuantizer::StreamOffset(const MeshData& mesh, const VertexEncoding& enc, uint32_t stream) {
+    VertexInputDescription desc = enc.GetInputDescription();
+
+    VkDeviceSize offset = 0;
+    for (uint32_t s = 0; s < stream && s < desc.bindingCount; ++s) {
+        offset += VkDeviceSize(mesh.vertices.size()) * desc.bindings[s].stride;
+        offset  = (offset + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1);
+    }
+
+    return offset;
+}
+
+VkDeviceSize VertexQuantizer::BufferSize(const MeshData& mesh, const VertexEncoding& enc) {
+    VertexInputDescription desc = enc.GetInputDescription();
+
+    return StreamOffset(mesh, enc, desc.bindingCount - 1)
+         + VkDeviceSize(mesh.vertices.size()) * desc.bindings[desc.bindingCount - 1].stride;
+}
+
+void VertexQuantizer::Pack(const MeshData& mesh, const VertexEncoding& enc, void* dst) {
+    VertexInputDescription desc = enc.GetInputDescription();
+
+    // where attribute a of vertex 0 goes; locations 0, 1, 2 are position, colour, uv
+    uint8_t* base[VertexInputDescription::MAX_ATTRIBUTES];
+    uint32_t stride[VertexInputDescription::MAX_ATTRIBUTES];
+
+    for (uint32_t a = 0; a < desc.attributeCount; ++a) {
+        const auto& attr = desc.attributes[a];
+
+        base[a]   = static_cast<uint8_t*>(dst) + StreamOffset(mesh, enc, attr.binding) + attr.offset;
+        stride[a] = desc.bindings[attr.binding].stride;
+    }
+
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const Vertex& v = mesh.vertices[i];
+        PackedVertex  p{};
+        const void*   src[3] = { v.position, v.color, v.texCoord };
+
+        if (enc.IsPacked()) {
+            p = PackVertex(v, enc);
+
+            src[0] = p.position;
+            src[1] = p.color;
+            src[2] = p.texCoord;
+        }
+
+        for (uint32_t a = 0; a < desc.attributeCount; ++a) {
+            std::memcpy(base[a] + i * stride[a], src[desc.attributes[a].location], desc.sizes[a]);
+        }
+    }
+}
+
+#pragma endregion
+/////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "MeshLoader.h"
+
+#include <array>
+#include <cstdint>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// 16 byte vertex: 16 bit position (half or snorm, w unused), RGBA8 colour, 16 bit uv.
+// Half the size of Vertex, and the fixed function fetch expands every field back to
+// float, so the shaders are unchanged. In the vertex buffer the position goes to its own
+// 8 byte stream, colour and uv share an 8 byte attribute stream.
+struct PackedVertex {
+    uint16_t position[4];
+    uint8_t  color[4];
+    uint16_t texCoord[2];
+};
+
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
+
+template <VkFormat PositionFormat, VkFormat TexCoordFormat>
+using PackedVertexLayout = VertexLayout<
+    VertexAttribute<0, VERTEX_STREAM_POSITION,   PositionFormat,           sizeof(PackedVertex::position)>,
+    VertexAttribute<1, VERTEX_STREAM_ATTRIBUTES, VK_FORMAT_R8G8B8A8_UNORM, sizeof(PackedVertex::color)>,
+    VertexAttribute<2, VERTEX_STREAM_ATTRIBUTES, TexCoordFormat,           sizeof(PackedVertex::texCoord)>>;
+
+// How a mesh's vertices are laid out in its vertex buffer. Quantized positions are stored
+// normalized to [-1, 1]; object space is position * positionScale + positionBias, which the
+// renderer folds into the model matrix.
+struct VertexEncoding {
+    enum class PositionFormat {
+        Float32,    // plain Vertex, nothing packed
+        Half,
+        Snorm16,
+    };
+
+    PositionFormat positionFormat   = PositionFormat::Float32;
+    VkFormat       texCoordFormat   = VK_FORMAT_R32G32_SFLOAT;
+    float          positionScale[3] = { 1.0f, 1.0f, 1.0f };
+    float          positionBias[3]  = { 0.0f, 0.0f, 0.0f };
+
+    bool     IsPacked() const { return positionFormat != PositionFormat::Float32; }
+
+    // one of the compile time layouts, picked by the formats above
+    VertexInputDescription GetInputDescription() const;
+};
+
+class VertexQuantizer {
+public:
+    enum class Mode {
+        Float,      // keep 32 bit floats
+        Half,
+        Snorm16,
+        Auto,       // most precise packed format within tolerance, else float
+    };
+
+    struct ErrorReport {
+        float positionMax      = 0.0f;  // object space units
+        float positionRms      = 0.0f;
+        float positionRelative = 0.0f;  // positionMax / bounding box diagonal
+        float colorMax         = 0.0f;
+        float texCoordMax      = 0.0f;
+    };
+
+    // tolerance is the accepted positionRelative for Auto
+    static VertexEncoding Choose(const MeshData& mesh, Mode mode, float tolerance = 1e-4f, ErrorReport* report = nullptr);
+
+    static ErrorReport    Measure(const MeshData& mesh, const VertexEncoding& encoding);
+    static void           PrintReport(const VertexEncoding& encoding, const ErrorReport& report);
+
+    // streams are stored back to back in one buffer, each starting STREAM_ALIGNMENT aligned
+    static constexpr VkDeviceSize STREAM_ALIGNMENT = 256;
+
+    static VkDeviceSize   StreamOffset(const MeshData& mesh, const VertexEncoding& encoding, uint32_t stream);
+    static VkDeviceSize   BufferSize(const MeshData& mesh, const VertexEncoding& encoding);
+
+    // dst must hold BufferSize() bytes
+    static void           Pack(const MeshData& mesh, const VertexEncoding& encoding, void* dst);
+
+    static PackedVertex   PackVertex(const Vertex& v, const VertexEncoding& encoding);
+    static Vertex         UnpackVertex(const PackedVertex& p, const VertexEncoding& encoding);
+
+    static uint16_t       FloatToHalf(float f);
+    static float          HalfToFloat(uint16_t h);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+// Small pure helpers over Vulkan structures, no device calls.
+
+// first memory type allowed by typeBits that has every one of flags, -1 when there is none
+inline int32_t FindMemoryType(const VkPhysicalDeviceMemoryProperties& memProps, uint32_t typeBits, VkMemoryPropertyFlags flags) {
+    for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i) {
+        if ((typeBits & (1u << i)) && ((memProps.memoryTypes[i].propertyFlags & flags) == flags)) {
+            return static_cast<int32_t>(i);
+        }
+    }
+
+    return -1;
+}
+
+// one descriptor at binding, array element 0
+inline VkWriteDescriptorSet BufferDescriptorWrite(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorBufferInfo* bufferInfo) {
+    return VkWriteDescriptorSet {
+        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        nullptr,
+        set,
+        binding,
+        0,
+        1,
+        type,
+        nullptr,
+        bufferInfo,
+        nullptr
+    };
+}
+
+inline VkWriteDescriptorSet ImageDescriptorWrite(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo* imageInfo) {
+    return VkWriteDescriptorSet {
+        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        nullptr,
+        set,
+        binding,
+        0,
+        1,
+        type,
+        imageInfo,
+        nullptr,
+        nullptr
+    };
+}
@@ -1,5 +1,6 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#include <psapi.h>
 
 #include <vulkan/vulkan.h>
 #include <iostream>
@@ -13,6 +14,10 @@
 #include <fstream>
 #include <map>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <utility>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -22,53 +27,37 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "Scene.h"
+#include "Vertex.h"
+#include "MeshLoader.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "AssetPack.h"
+#include "Benchmark.h"
+#include "Camera.h"
+#include "DeletionQueue.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "FrameReadback.h"
+#include "CpuProfiler.h"
+#include "GpuProfiler.h"
+#include "RenderGraph.h"
+#include "ResizeStorm.h"
+#include "ResolutionScaler.h"
+#include "RetireQueue.h"
+#include "TransientMemory.h"
+#include "ThreadPool.h"
+#include "AsyncTextureLoader.h"
+#include "VertexQuantizer.h"
+#include "VulkanUtil.h"
+
 #define APPLICATION_NAME        "SimpleTriangle"
 #define WINDOW_WIDTH            1920
 #define WINDOW_HEIGHT           1080
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-struct Vertex {
-    float position[3];
-    float color[3];
-    float texCoord[2];
-
-    static VkVertexInputBindingDescription GetInputBindingDescription() {
-        return {
-            0, // binding
-            sizeof(Vertex), // stride
-            VK_VERTEX_INPUT_RATE_VERTEX // data is per vertex
-        };
-    }
-
-    static std::array<VkVertexInputAttributeDescription, 3> GetInputAttributeDescriptionArray() {
-        std::array<VkVertexInputAttributeDescription, 3> val{};
-
-        val[0] = {
-            0, // location
-            0, // binding
-            VK_FORMAT_R32G32B32_SFLOAT,
-            offsetof(Vertex,position)
-        };
-
-        val[1] = {
-            1, // location
-            0, // binding
-            VK_FORMAT_R32G32B32_SFLOAT,
-            offsetof(Vertex,color)
-        };
-
-        val[2] = {
-            2, // location
-            0, // binding
-            VK_FORMAT_R32G32_SFLOAT,
-            offsetof(Vertex,texCoord)
-        };
-
-        return val;
-    }
-};
-
 static Vertex vertices[12] = {
     {{ 0.5f,  0.0f, -0.5f}, {0.0f, 0.0f, 1.0f}, {0.5f, 0.5f}},
     {{ 0.0f,  1.0f,  0.0f}, {1.0f, 1.0f, 0.0f}, {1.0f, 0.0f}},
@@ -94,49 +83,78 @@ static uint16_t indices[12] = {
     9, 10, 11
 };
 
-struct UniformBufferObject {
-    glm::mat4 model;
-};
+// command line switches
+struct LaunchOptions {
+    std::string meshPath;               // empty: built-in pyramid
+    bool        optimizeMesh = true;    // vertex cache / overdraw / fetch reordering at load
 
-struct PushConstant {
-    glm::mat4 viewProj;
-};
+    VertexQuantizer::Mode vertexFormat = VertexQuantizer::Mode::Auto;
 
-/////////////////////////////////////////////////////////////////////////////////////////////
+    bool        depthPrepass = true;    // position only depth pass, colour pass tests EQUAL
+    bool        clusterCull  = true;    // per meshlet frustum & backface culling in compute
 
-class DeletionQueue {
-    using fn = std::function<void()>;
-    using queue = std::deque<fn>;
+    uint32_t    lodCount     = 5;       // levels including full detail, 1 disables simplification
+    float       lodThreshold = 1.0f;    // accepted screen space error in pixels
 
-    queue dq;
+    std::string texturePath  = "textures/checkerboard.png";    // PNG, or KTX2 with BC1/BC7/ASTC mips
+    bool        cpuMips      = false;   // build texture mips on the CPU instead of with blits
 
-public:
-    void Finalize() {
-        // delete in reverse order of appends
-        for (auto it = dq.rbegin(); it != dq.rend(); it++) {
-            (*it)();
-        }
+    std::string packPath     = "assets.pak";    // shaders and textures found here skip the loose files
 
-        dq.clear();
-    }
+    bool        hostImageCopy = true;   // VK_EXT_host_image_copy uploads where the device has it
 
-    template<typename Fn>
-    void Append(Fn&& f) {
-        dq.emplace_back(f);
-    }
+    float       frameBudgetMs  = 0.0f;             // GPU time dynamic resolution aims for, 0: always full
+    float       minRenderScale = 0.5f;
+
+    bool        gpuProfile   = false;   // print per pass GPU times
+    std::string gpuTracePath;           // Chrome trace of the last frames' GPU passes, written at exit
+    std::string cpuTracePath;           // same for CPU zones, builds with HARMONY_CPU_PROFILER only
+
+    uint32_t    benchmarkFrames = 0;    // measured frames, 0: run until closed
+    uint32_t    warmupFrames    = 120;
+    float       timestepMs      = 1000.0f / 60.0f;     // animation step per benchmark frame
+    std::string benchmarkPath;          // results as .json or .csv
+
+    std::string capturePath;            // frames to .png / .rgba files or a .y4m stream
+    uint32_t    captureEvery = 1;       // every Nth frame
+
+    uint32_t    resizeStorm  = 0;       // resizes of the swapchain stress run, 0: off
+
+    bool        lowLatency    = false;  // start frames just in time for the GPU
+    bool        reportLatency = false;  // measure frame start to GPU completion, implied by lowLatency
+};
+
+// everything per frame the scene's draws read, so recorded draws can be replayed
+struct UniformBufferObject {
+    glm::mat4 model;
+    glm::mat4 viewProj;
+};
+
+// cull.comp, in the mesh's object space
+struct CullConstants {
+    glm::vec4 planes[6];
+    glm::vec3 cameraPosition;
+    uint32_t  meshletCount;
+    uint32_t  firstMeshlet;
 };
 
+static_assert(sizeof(CullConstants) <= 128, "CullConstants must fit the minimum push constant size");
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 #pragma region ClassDecl
 class alignas(64) Harmony {
 public:
     static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+    static constexpr uint32_t GPU_TRACE_FRAMES     = 600;
 
-    bool Init(HINSTANCE instance);
+    bool Init(HINSTANCE instance, const LaunchOptions& options);
     void Run();
     void Shutdown(HINSTANCE instance);
     void Resize();
 
+    // non zero when a stress run failed
+    int  ExitCode() const;
+
 private:
     struct QueueFamilyIndices {
         std::optional<uint32_t>  graphicsFamily;
@@ -174,46 +192,89 @@ private:
     void OpenWindow(HINSTANCE instance);
     void CreateSurface(HINSTANCE instance);
     void ChoosePhysicalDevice();
+    bool HasDeviceExtension(const char* name);
+    void CheckHostImageCopy();
+    void CheckCalibratedTimestamps();
     void CreateLogicalDevice();
     void CreateSwapChain();
     void CreateCommandPoolAndBuffers();
     void CreateSyncObjects();
+    uint32_t GraphicsTimestampBits();
+    void CreateGpuProfiler();
+    void CreateFrameReadback();
     void CreateImageViews();
 
     void CreateRenderPass();
+    void LoadMesh(const LaunchOptions& options);
     void CreateUniformBuffer();
     void CreateVertexBuffer(VkCommandBuffer cmdBuffer);
     void CreateIndexBuffer(VkCommandBuffer cmdBuffer);
-    void CreateTextureImageAndView(VkCommandBuffer cmdBuffer);
+    void CreateMeshletBuffer(VkCommandBuffer cmdBuffer);
+    void OpenAssetPack(const std::string& packPath);
+    void RequestTextures();
+    void CreatePlaceholderTexture(VkCommandBuffer cmdBuffer);
     void CreateTextureSampler();
-    void CreateDepthImageAndView();
+    void CreateTransientAttachments();
+    void DestroyTransientAttachments();
+    void RetireTransientAttachments();
 
     void CreateDescriptorPoolAndSets();
 
     void CreateFrameBuffers();
     void CreateDescriptorSetLayout();
     void CreateGraphicsPipeline();
+    VkShaderModule CreateShaderModule(const char* fileName);
+    void CreateClusterCulling();
+
+    void CreateScene();
     
-    void UpdateUbo(uint32_t imageIndex);
+    void UpdateUbo(uint32_t slot);
+    uint32_t SelectLod(const glm::mat4& meshToWorld, const glm::mat4& view, const glm::mat4& proj) const;
     void RecordCommandBuffer(VkCommandBuffer cmdBuffer, uint32_t imageIndex);
+    void RecordCullPass(VkCommandBuffer cmdBuffer, uint32_t slot);
+    void RecordScenePass(VkCommandBuffer cmdBuffer, uint32_t slot, VkImageView colorView);
+    VkCommandBuffer SceneCommands(uint32_t slot);
+    void RecordSceneDraws(VkCommandBuffer cmdBuffer, uint32_t slot);
+    void RecordUpscalePass(VkCommandBuffer cmdBuffer, uint32_t imageIndex);
+    void UpdateRenderScale();
+    void CollectGpuFrame(uint32_t slot);
+    void DrawMesh(VkCommandBuffer cmdBuffer, uint32_t slot);
+    void StreamTextures();
+    void RetireUploads();
+    void UpdateTextureDescriptor(uint32_t slot);
     void Render();
-
+    void StepResizeStorm();
+    double PaceFrame();
+    void CalibrateGpuClock();
+    double GpuTicksToHostMs(uint64_t ticks) const;
+    void SleepUntil(double hostMs);
+    ResizeStorm::Sample SampleMemory();
+
+    bool     HasMemoryType(uint32_t typeBits, VkMemoryPropertyFlags mpFlags);
     uint32_t SearchMemoryType(uint32_t typeBits, VkMemoryPropertyFlags mpfFlags);
 
     BufferInfo CreateBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memPropFlags, VkDeviceSize size);
     void DestroyBuffer(BufferInfo& buffInfo, bool defer = false);
     
-    ImageInfo CreateImage(VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags memPropFlags, VkImageAspectFlags aspectFlags, uint32_t width, uint32_t height);
+    ImageInfo CreateImage(VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags memPropFlags, VkImageAspectFlags aspectFlags, uint32_t width, uint32_t height, uint32_t mipLevels = 1);
     void DestroyImage(ImageInfo& imgInfo, bool defer=false);
 
+    // destroyed once the frame being recorded has finished on the GPU
+    void RetireBuffer(BufferInfo& buffInfo);
+    void RetireImage(ImageInfo& imgInfo);
+
     void CopyBuffer(VkCommandBuffer cmdBuffer, VkBuffer src, VkBuffer dst, VkDeviceSize size);
-    void CopyBufferToImage(VkCommandBuffer cmdBuffer, VkBuffer src, VkImage image, uint32_t width, uint32_t height);
-    void TransitionImage(VkCommandBuffer cmdBuffer, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageLayout oldLayout, VkImageLayout newLayout);
+    void CopyBufferToImage(VkCommandBuffer cmdBuffer, VkBuffer src, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevel = 0, VkDeviceSize bufferOffset = 0);
+    void GenerateMipmaps(VkCommandBuffer cmdBuffer, VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels);
+    ImageInfo UploadTexture(VkCommandBuffer cmdBuffer, const DecodedTexture& texture, BufferInfo& stagingBuffer);
+    bool      CanHostCopy(const DecodedTexture& texture);
+    ImageInfo HostCopyTexture(const DecodedTexture& texture);
 
     VkCommandBuffer BeginOneTimeCommands();
     void EndOneTimeCommands(VkCommandBuffer cmdBuffer);
+    VkFence SubmitOneTimeCommands(VkCommandBuffer cmdBuffer);
 
-    VkImageView CreateImageView(VkImage image, VkFormat imageFormat, VkImageAspectFlags aspectFlags);
+    VkImageView CreateImageView(VkImage image, VkFormat imageFormat, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
 
     VkFormat findSuitableFormat(const std::vector<VkFormat>& formats, VkImageTiling tiling, VkFormatFeatureFlags features);
 
@@ -230,8 +291,16 @@ private:
         return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
     }
 
+    VkImageAspectFlags DepthAspectFlags() const {
+        return VK_IMAGE_ASPECT_DEPTH_BIT | (HasStencilComponent(depthFormat) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+    }
+
     static std::vector<char> readShaderFile(const std::string& filePath);
 
+    // QueryPerformanceCounter in ms, the clock calibrated timestamps map GPU time onto
+    static double HostMs();
+    static double HostTicksToMs(uint64_t ticks);
+
     using SwapChainImageVec       = std::vector<VkImage>;
     using SwapChainImageViewVec   = std::vector<VkImageView>;
     using SwapChainFramebufferVec = std::vector<VkFramebuffer>;
@@ -240,6 +309,7 @@ private:
     using FenceVec                = std::vector<VkFence>;
     using DescriptorSetVec        = std::vector<VkDescriptorSet>;
     using UboVec                  = std::vector<BufferInfo>;
+    using IndirectBufferVec       = std::vector<BufferInfo>;
     
     HWND                     hMainWindow         = NULL;
 
@@ -258,6 +328,7 @@ private:
     VkDescriptorSetLayout    descriptorSetLayout = VK_NULL_HANDLE;
     VkPipelineLayout         pipelineLayout      = VK_NULL_HANDLE;
     VkPipeline               graphicsPipeline    = VK_NULL_HANDLE;
+    VkPipeline               depthPrepassPipeline = VK_NULL_HANDLE;
     VkCommandPool            commandPool         = VK_NULL_HANDLE;
     VkCommandPool            commandPoolTx       = VK_NULL_HANDLE;
     VkDescriptorPool         descriptorPool      = VK_NULL_HANDLE;
@@ -265,6 +336,13 @@ private:
 
     PFN_vkGetPipelineExecutablePropertiesKHR  vkGetPipelineExecutableProperties = VK_NULL_HANDLE;
     PFN_vkGetPipelineExecutableInternalRepresentationsKHR vkGetPipelineExecutableInternalRepresentations = VK_NULL_HANDLE;
+    PFN_vkCopyMemoryToImageEXT                vkCopyMemoryToImage        = VK_NULL_HANDLE;
+    PFN_vkTransitionImageLayoutEXT            vkTransitionImageLayout    = VK_NULL_HANDLE;
+    PFN_vkGetCalibratedTimestampsEXT          vkGetCalibratedTimestamps  = VK_NULL_HANDLE;
+
+    // textures written from host memory without staging buffer or command buffer, straight
+    // into SHADER_READ_ONLY_OPTIMAL; only when the device lists it as a host copy destination
+    bool                     hostImageCopy       = false;
 
     VkBool32                 windowResized       = VK_FALSE;
 
@@ -273,11 +351,145 @@ private:
     BufferInfo               vertexBufferInfo;
     BufferInfo               indexBufferInfo;
     ImageInfo                textureInfo;
-    ImageInfo                depthInfo;
+    std::string              texturePath;
+    bool                     cpuMips             = false;
+    ImageInfo                depthInfo;         // memory is transient
+
+    // attachments that only live inside a frame share allocations: lazily allocated (tile
+    // memory only) for the ones never stored, where the device has such a memory type
+    std::vector<ImageInfo*>  transientImageVec;
+    std::vector<VkDeviceMemory> transientMemoryVec;
+
+    // order of the frame graph's passes, which transient lifetimes are given in
+    enum FramePass : uint32_t {
+        CullPass,
+        ScenePass,
+        UpscalePass,
+    };
+
+    // GPU time of every frame and graph pass, read back when the frame's fence has signalled
+    GpuProfiler              gpuProfiler;
+    uint32_t                 timestampBits       = 0;       // of the graphics queue, 0: no timestamps
+    bool                     gpuProfile          = false;
+    uint32_t                 gpuReportFrames     = 0;
+    std::string              gpuTracePath;
+    std::string              cpuTracePath;      // empty: CPU zones are never collected
+
+    // fixed timestep run that ends itself; numbers the frame each command buffer holds
+    std::optional<Benchmark> benchmark;
+    std::string              benchmarkPath;
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> benchmarkFrameVec = {};
+
+    // frame capture: the swapchain image is copied out after the frame's last pass and
+    // encoded on the thread pool once the fence has signalled; frames without a free
+    // readback buffer are dropped rather than waited for
+    std::unique_ptr<FrameCapture> frameCapture;
+    std::string              capturePath;
+    FrameReadback            frameReadback;
+    bool                     swapchainReadback   = false;   // the swapchain can be copied from
+    uint64_t                 frameNumber         = 0;       // frames submitted
+
+    // resizes the window every frame and checks memory stays flat; device memory is read
+    // through VK_EXT_memory_budget where the device has it
+    std::optional<ResizeStorm> resizeStorm;
+    bool                     memoryBudget        = false;
+
+    // latency: frame ends are GPU timestamps mapped onto the performance counter through
+    // VK_EXT_calibrated_timestamps, recalibrated as the clocks drift; with lowLatency each
+    // frame sleeps until the pacer's wake time before sampling the animation
+    std::optional<FramePacer> framePacer;
+    bool                     lowLatency          = false;
+    bool                     calibratedTimestamps = false;
+    uint64_t                 gpuClockTicks       = 0;       // device timestamp at the calibration
+    double                   gpuClockHostMs      = 0.0;     // the host time it was taken at
+    HANDLE                   pacingTimer         = NULL;
+
+    // dynamic resolution: below full scale the scene is drawn at renderExtent into
+    // sceneColorInfo and blitted up to the swapchain image, sized by the profiled frame time
+    bool                     dynamicResolution   = false;
+    ResolutionScaler         resolutionScaler    { 0.0f, 1.0f };
+    VkExtent2D               renderExtent        = {};
+    ImageInfo                sceneColorInfo;    // memory is transient
+    std::array<float, MAX_FRAMES_IN_FLIGHT> frameScaleVec = {};     // per command buffer, 0: not measured yet
+    std::array<float, MAX_FRAMES_IN_FLIGHT> frameGpuMsVec = {};     // collected, not yet seen by the scaler
 
     DeletionQueue            deletionQueue;
 
+    // objects released mid run, per frame slot; slotFrameVec is the frame count up to and
+    // including the slot's last submitted frame, which its fence signalling completes
+    RetireQueue              retireQueue;
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> slotFrameVec = {};
+
+    // rebuilt by every RecordCommandBuffer, owns the frame's barriers
+    RenderGraph              frameGraph;
+
+    // mapped for the whole run; outlives the decode jobs that read from it
+    AssetPack                    assetPack;
+
+    // texture decoding off the render thread; uploads in flight keep their staging memory
+    struct PendingUpload {
+        VkFence                  fence           = VK_NULL_HANDLE;
+        VkCommandBuffer          cmdBuffer       = VK_NULL_HANDLE;
+        BufferInfo               stagingBuffer;
+    };
+
+    ThreadPool                   threadPool;
+    std::unique_ptr<AsyncTextureLoader> textureLoader;
+    std::vector<PendingUpload>   pendingUploads;
+    std::array<bool, MAX_FRAMES_IN_FLIGHT>    textureDescDirtyVec = {};
+    std::vector<ImageInfo>       replacedTextureVec;     // still bound to a descriptor set
+
+    Scene                    scene;
+    Scene::NodeId            pyramidPivotNode    = Scene::INVALID_NODE;
+    Scene::NodeId            pyramidNode         = Scene::INVALID_NODE;
+    Scene::NodeId            meshNode            = Scene::INVALID_NODE;
+
+    Scene::NodeId            meshDequantNode     = Scene::INVALID_NODE;
+
+    MeshData                 mesh;
+    VertexEncoding           vertexEncoding;
+    VertexInputDescription   vertexInput;
+    VkDeviceSize             vertexStreamOffsets[VertexInputDescription::MAX_STREAMS] = {};
+
+    bool                     depthPrepass        = true;
+
+    std::vector<MeshLod>     lods;
+    float                    lodThreshold        = 1.0f;
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> lodVec = {};
+
+    // per frame triangle counts over the run, printed at exit
+    uint64_t                 lodTriangleSum      = 0;
+    uint64_t                 lodFrameCount       = 0;
+
+    std::vector<Meshlet>     meshlets;
+    bool                     clusterCull         = true;
+    BufferInfo               meshletBufferInfo;
+    IndirectBufferVec        drawCommandBufferVec;
+    VkDescriptorSetLayout    cullDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool         cullDescriptorPool  = VK_NULL_HANDLE;
+    VkPipelineLayout         cullPipelineLayout  = VK_NULL_HANDLE;
+    VkPipeline               cullPipeline        = VK_NULL_HANDLE;
+    DescriptorSetVec         cullDescSetVec;
+    std::array<CullConstants, MAX_FRAMES_IN_FLIGHT> cullConstantVec;
+
     CmdBufferVec             cmdBufferVec;
+
+    // the scene's draws, recorded into a secondary command buffer per slot and replayed
+    // frame after frame until something recorded into them changes; everything else per
+    // frame comes from the slot's UBO and draw command buffer. Off while pipeline
+    // statistics are gathered, which would have to be inherited into them
+    struct SceneCommandBuffer {
+        VkCommandBuffer      cmdBuffer   = VK_NULL_HANDLE;
+        VkExtent2D           extent      = {};
+        VkFormat             colorFormat = VK_FORMAT_UNDEFINED;
+        VkFormat             depthFormat = VK_FORMAT_UNDEFINED;
+        uint32_t             lod         = UINT32_MAX;
+        bool                 dirty       = true;    // its descriptor set was written
+    };
+
+    std::array<SceneCommandBuffer, MAX_FRAMES_IN_FLIGHT> sceneCommandVec;
+    bool                     reuseSceneCommands  = false;
+    uint64_t                 sceneRecordCount    = 0;
     SemaphoreVec             imageReadyVec;
     SemaphoreVec             renderCompleteVec;
     FenceVec                 gpuBusyVec;
@@ -287,11 +499,11 @@ private:
     SwapChainFramebufferVec  swapChainFramebufferVec;
 
     UboVec                   uboVec;
-    std::array<PushConstant, MAX_FRAMES_IN_FLIGHT>  pushConstantVec;
 
     QueueFamilyIndices          choosenQueueIndices;
     VkPhysicalDeviceProperties2 chosenDeviceProps;
     VkPhysicalDeviceFeatures2   choosenDeviceFeatures;
+    VkPhysicalDeviceMemoryProperties memoryProps {};
     
     VkFormat                 swapChainImageFormat;
     VkFormat                 depthFormat;
@@ -341,6 +553,23 @@ VKAPI_ATTR VkBool32 VKAPI_CALL Harmony::DebugCallback(VkDebugUtilsMessageSeverit
     return VK_FALSE;
 }
 
+double Harmony::HostMs() {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    return HostTicksToMs(static_cast<uint64_t>(now.QuadPart));
+}
+
+double Harmony::HostTicksToMs(uint64_t ticks) {
+    static const double ticksPerMs = [] {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return double(frequency.QuadPart) / 1000.0;
+    }();
+
+    return double(ticks) / ticksPerMs;
+}
+
 std::vector<char> Harmony::readShaderFile(const std::string& filePath) {
     std::fstream file;
     std::vector<char> fileData;
@@ -365,8 +594,53 @@ std::vector<char> Harmony::readShaderFile(const std::string& filePath) {
 #pragma endregion
 /////////////////////////////////////////////////////////////////////////////////////////////
 #pragma region Public interface
-bool Harmony::Init(HINSTANCE hinstance) {
+bool Harmony::Init(HINSTANCE hinstance, const LaunchOptions& options) {
+    CPU_FUNCTION_ZONE();
+
     try {
+        texturePath = options.texturePath;
+        cpuMips     = options.cpuMips;
+
+        gpuProfile   = options.gpuProfile;
+        gpuTracePath = options.gpuTracePath;
+
+        if (options.benchmarkFrames) {
+            benchmark.emplace(options.warmupFrames, options.benchmarkFrames, options.timestepMs);
+            benchmarkPath = options.benchmarkPath;
+        }
+
+        // a sample waits for a fence of every slot to have come round twice
+        if (options.resizeStorm) {
+            resizeStorm.emplace(options.resizeStorm, 2 * MAX_FRAMES_IN_FLIGHT);
+        }
+
+        // a millisecond of slack for the prediction being short
+        if (options.lowLatency || options.reportLatency) {
+            framePacer.emplace(1.0f);
+            lowLatency = options.lowLatency;
+        }
+
+        // frames are a timestep apart in a benchmark, otherwise nominally so
+        if (!options.capturePath.empty()) {
+            const uint32_t frameUs = static_cast<uint32_t>(std::lround(options.timestepMs * 1000.0f));
+
+            frameCapture = std::make_unique<FrameCapture>(options.capturePath, options.captureEvery, 1000000, frameUs * std::max(options.captureEvery, 1u));
+            capturePath  = options.capturePath;
+        }
+
+        if (CpuProfiler::COMPILED_IN) {
+            cpuTracePath = options.cpuTracePath;
+        }
+        else if (!options.cpuTracePath.empty()) {
+            std::cout << "Built without HARMONY_CPU_PROFILER, no CPU trace" << std::endl;
+        }
+
+        resolutionScaler = ResolutionScaler(options.frameBudgetMs, std::clamp(options.minRenderScale, 0.1f, 1.0f));
+
+        OpenAssetPack(options.packPath);
+
+        LoadMesh(options);
+
         CreateInstance();
 
         OpenWindow(hinstance);
@@ -375,6 +649,21 @@ bool Harmony::Init(HINSTANCE hinstance) {
 
         ChoosePhysicalDevice();
 
+        // frames are timed on the GPU, which also picks their resolution; a benchmark keeps
+        // every frame at full size so runs stay comparable
+        timestampBits     = GraphicsTimestampBits();
+        dynamicResolution = options.frameBudgetMs > 0.0f && timestampBits != 0 && !benchmark;
+
+        if (options.hostImageCopy) {
+            CheckHostImageCopy();
+        }
+
+        if (framePacer && timestampBits) {
+            CheckCalibratedTimestamps();
+        }
+
+        RequestTextures();
+
         CreateLogicalDevice();
 
         CreateSwapChain();
@@ -383,9 +672,23 @@ bool Harmony::Init(HINSTANCE hinstance) {
 
         CreateSyncObjects();
 
+        CreateGpuProfiler();
+
+        if (framePacer && !(gpuProfiler.IsEnabled() && calibratedTimestamps)) {
+            std::cout << "Latency needs GPU timestamps and VK_EXT_calibrated_timestamps with the performance counter, no latency mode" << std::endl;
+            framePacer.reset();
+            lowLatency = false;
+        }
+
+        if (framePacer) {
+            CalibrateGpuClock();
+        }
+
+        CreateFrameReadback();
+
         CreateImageViews();
 
-        CreateDepthImageAndView();
+        CreateTransientAttachments();
 
         // CreateRenderPass();
 
@@ -397,7 +700,9 @@ bool Harmony::Init(HINSTANCE hinstance) {
 
         CreateIndexBuffer(cmdBuffer);
 
-        CreateTextureImageAndView(cmdBuffer);
+        CreateMeshletBuffer(cmdBuffer);
+
+        CreatePlaceholderTexture(cmdBuffer);
 
         EndOneTimeCommands(cmdBuffer);
 
@@ -414,6 +719,10 @@ bool Harmony::Init(HINSTANCE hinstance) {
         CreateDescriptorPoolAndSets();
 
         CreateGraphicsPipeline();
+
+        CreateClusterCulling();
+
+        CreateScene();
     }
     catch (std::runtime_error& err) {
         MessageBox(0, err.what(), "Error!", MB_OK);
@@ -437,7 +746,19 @@ void Harmony::Run() {
             break;
         }
 
+        if (resizeStorm) {
+            StepResizeStorm();
+
+            if (resizeStorm->Done()) {
+                break;
+            }
+        }
+
         Render();
+
+        if (benchmark && benchmark->Done()) {
+            break;
+        }
     }
 
     vkDeviceWaitIdle(device);
@@ -445,6 +766,67 @@ void Harmony::Run() {
 
 void Harmony::Shutdown(HINSTANCE hinstance) {
     try {
+        // the last frames' readbacks join the queue; decodes still running query the device,
+        // uploads still own staging buffers
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+            frameReadback.Collect(static_cast<uint32_t>((currentFrame + i) % MAX_FRAMES_IN_FLIGHT));
+        }
+
+        threadPool.WaitIdle();
+        RetireUploads();
+
+        // Run has waited for the device, every submitted frame can be read
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+            CollectGpuFrame(static_cast<uint32_t>((currentFrame + i) % MAX_FRAMES_IN_FLIGHT));
+        }
+
+        if (benchmark) {
+            benchmark->Print(std::cout);
+
+            if (!benchmarkPath.empty()) {
+                benchmark->Write(benchmarkPath);
+                std::cout << "Benchmark results: " << benchmarkPath << std::endl;
+            }
+        }
+
+        if (resizeStorm) {
+            resizeStorm->Print(std::cout);
+        }
+
+        if (framePacer) {
+            framePacer->Print(std::cout, lowLatency);
+        }
+
+        if (lods.size() > 1 && lodFrameCount) {
+            std::cout << "LODs: " << lodTriangleSum / lodFrameCount << " triangles/frame on average, "
+                      << lods[0].indexCount / 3 << " at full detail" << std::endl;
+        }
+
+        if (reuseSceneCommands) {
+            std::cout << "Scene draws recorded " << sceneRecordCount << " times in " << frameNumber << " frames" << std::endl;
+        }
+
+        if (frameCapture) {
+            std::cout << "Captured " << frameCapture->WrittenCount() << " frames to " << capturePath << ", "
+                      << frameReadback.DroppedCount() << " dropped without a free readback buffer";
+
+            if (frameCapture->SkippedCount()) {
+                std::cout << ", " << frameCapture->SkippedCount() << " of another size left out of the stream";
+            }
+
+            std::cout << std::endl;
+        }
+
+        if (!gpuTracePath.empty() && gpuProfiler.IsEnabled()) {
+            gpuProfiler.WriteTrace(gpuTracePath);
+            std::cout << "GPU trace: " << gpuTracePath << std::endl;
+        }
+
+        if (!cpuTracePath.empty()) {
+            CpuProfiler::WriteTrace(cpuTracePath);
+            std::cout << "CPU trace: " << cpuTracePath << std::endl;
+        }
+
         deletionQueue.Finalize();
     }
     catch (std::runtime_error& err) {
@@ -456,11 +838,17 @@ void Harmony::Resize() {
     windowResized = VK_TRUE;
 }
 
+int Harmony::ExitCode() const {
+    return resizeStorm && !resizeStorm->Passed() ? 1 : 0;
+}
+
 #pragma endregion
 /////////////////////////////////////////////////////////////////////////////////////////////
 #pragma region Init Calls
 
 void Harmony::CreateInstance() {
+    CPU_FUNCTION_ZONE();
+
     uint32_t itemCount = 0;
     VkResult result;
 
@@ -578,6 +966,8 @@ void Harmony::CreateInstance() {
 }
 
 void Harmony::OpenWindow(HINSTANCE hinstance) {
+    CPU_FUNCTION_ZONE();
+
     WNDCLASSEX wcex {
         sizeof(WNDCLASSEX),
         CS_HREDRAW | CS_VREDRAW,
@@ -642,6 +1032,8 @@ void Harmony::OpenWindow(HINSTANCE hinstance) {
 }
 
 void Harmony::CreateSurface(HINSTANCE hinstance) {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     VkWin32SurfaceCreateInfoKHR createInfo {
@@ -666,6 +1058,8 @@ void Harmony::CreateSurface(HINSTANCE hinstance) {
 }
  
 void Harmony::ChoosePhysicalDevice() {
+    CPU_FUNCTION_ZONE();
+
     uint32_t itemCount = 0;
     VkResult result;
 
@@ -779,10 +1173,6 @@ void Harmony::ChoosePhysicalDevice() {
             score += 500;
         }
 
-        if (deviceProps.properties.limits.maxPushConstantsSize < sizeof(PushConstant)) {
-            return 0;
-        }
-
         // we need VK 1.3 for dynamic rendering
         uint32_t major = VK_API_VERSION_MAJOR(deviceProps.properties.apiVersion);
         uint32_t minor = VK_API_VERSION_MINOR(deviceProps.properties.apiVersion);
@@ -842,9 +1232,101 @@ void Harmony::ChoosePhysicalDevice() {
     choosenQueueIndices   = myDevice.indices;
     chosenDeviceProps     = myDevice.deviceProps;
     choosenDeviceFeatures = myDevice.deviceFeats;
+
+    // fixed for the device's lifetime, every allocation searches it
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProps);
+}
+
+bool Harmony::HasDeviceExtension(const char* name) {
+    uint32_t itemCount = 0;
+
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &itemCount, nullptr);
+    std::vector<VkExtensionProperties> extPropsVec(itemCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &itemCount, extPropsVec.data());
+
+    return std::any_of(extPropsVec.begin(), extPropsVec.end(), [name](const VkExtensionProperties& ext) {
+        return std::string(ext.extensionName) == name;
+    });
+}
+
+void Harmony::CheckHostImageCopy() {
+    CPU_FUNCTION_ZONE();
+
+    if (!HasDeviceExtension(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME)) {
+        return;
+    }
+
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostCopyFeats {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+        nullptr,
+        VK_FALSE
+    };
+
+    VkPhysicalDeviceFeatures2 feats {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        &hostCopyFeats,
+    };
+
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &feats);
+    if (!hostCopyFeats.hostImageCopy) {
+        return;
+    }
+
+    // two calls, the first one only counts the layouts; source layouts are not needed, the
+    // pointer left null only has their count written
+    VkPhysicalDeviceHostImageCopyPropertiesEXT hostCopyProps {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT,
+    };
+
+    VkPhysicalDeviceProperties2 props {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        &hostCopyProps,
+    };
+
+    vkGetPhysicalDeviceProperties2(physicalDevice, &props);
+
+    std::vector<VkImageLayout> dstLayouts(hostCopyProps.copyDstLayoutCount);
+
+    hostCopyProps.pCopyDstLayouts = dstLayouts.data();
+
+    vkGetPhysicalDeviceProperties2(physicalDevice, &props);
+
+    // both the host transition out of UNDEFINED and the copy need the sampled layout listed as
+    // a copy destination; otherwise textures take the staging upload
+    hostImageCopy = std::find(dstLayouts.begin(), dstLayouts.end(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) != dstLayouts.end();
+}
+
+void Harmony::CheckCalibratedTimestamps() {
+    CPU_FUNCTION_ZONE();
+
+    if (!HasDeviceExtension(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+        return;
+    }
+
+    auto getTimeDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+        vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+
+    if (!getTimeDomains) {
+        return;
+    }
+
+    uint32_t itemCount = 0;
+
+    getTimeDomains(physicalDevice, &itemCount, nullptr);
+    std::vector<VkTimeDomainEXT> domains(itemCount);
+    getTimeDomains(physicalDevice, &itemCount, domains.data());
+
+    // device ticks next to QueryPerformanceCounter, the clock frames are timed with on the host
+    auto has = [&](VkTimeDomainEXT domain) {
+        return std::find(domains.begin(), domains.end(), domain) != domains.end();
+    };
+
+    calibratedTimestamps = has(VK_TIME_DOMAIN_DEVICE_EXT) && has(VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT);
 }
 
 void Harmony::CreateLogicalDevice() {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     std::vector<const char*> requiredExtensions = {
@@ -882,12 +1364,39 @@ void Harmony::CreateLogicalDevice() {
         VK_TRUE
     };
 
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostCopyFeats {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+        &plFeats,
+        VK_TRUE
+    };
+
+    VkPhysicalDeviceSynchronization2Features sync2Feats {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
+        hostImageCopy ? static_cast<void*>(&hostCopyFeats) : static_cast<void*>(&plFeats),
+        VK_TRUE
+    };
+
     VkPhysicalDeviceDynamicRenderingFeatures dynRenderingFeats {
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES,
-        &plFeats,
+        &sync2Feats,
         VK_TRUE
     };
 
+    if (hostImageCopy) {
+        requiredExtensions.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+    }
+
+    if (calibratedTimestamps) {
+        requiredExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+    }
+
+    // only the resize storm reads the budget
+    memoryBudget = resizeStorm && HasDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    if (memoryBudget) {
+        requiredExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
     VkDeviceCreateInfo deviceCreateInfo {
         VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
         &dynRenderingFeats,
@@ -917,9 +1426,24 @@ void Harmony::CreateLogicalDevice() {
 
     this->vkGetPipelineExecutableProperties = (PFN_vkGetPipelineExecutablePropertiesKHR)vkGetDeviceProcAddr(device, "vkGetPipelineExecutablePropertiesKHR");
     this->vkGetPipelineExecutableInternalRepresentations = (PFN_vkGetPipelineExecutableInternalRepresentationsKHR)vkGetDeviceProcAddr(device, "vkGetPipelineExecutableInternalRepresentationsKHR");
+
+    if (hostImageCopy) {
+        this->vkCopyMemoryToImage     = (PFN_vkCopyMemoryToImageEXT)vkGetDeviceProcAddr(device, "vkCopyMemoryToImageEXT");
+        this->vkTransitionImageLayout = (PFN_vkTransitionImageLayoutEXT)vkGetDeviceProcAddr(device, "vkTransitionImageLayoutEXT");
+
+        hostImageCopy = vkCopyMemoryToImage && vkTransitionImageLayout;
+    }
+
+    if (calibratedTimestamps) {
+        this->vkGetCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(device, "vkGetCalibratedTimestampsEXT");
+
+        calibratedTimestamps = vkGetCalibratedTimestamps != VK_NULL_HANDLE;
+    }
 }
 
 void Harmony::CreateSwapChain() {
+    CPU_FUNCTION_ZONE();
+
     SurfaceCaps sCaps;
     VkResult    result;
     uint32_t    itemCount = 0;
@@ -980,8 +1504,11 @@ void Harmony::CreateSwapChain() {
         };
     }
 
-    uint32_t numImages = sCaps.surfaceCaps.minImageCount;
-    numImages = std::clamp<uint32_t>(numImages, sCaps.surfaceCaps.minImageCount + 1, sCaps.surfaceCaps.maxImageCount);
+    // maxImageCount 0: no limit
+    uint32_t numImages = sCaps.surfaceCaps.minImageCount + 1;
+    if (sCaps.surfaceCaps.maxImageCount) {
+        numImages = std::min(numImages, sCaps.surfaceCaps.maxImageCount);
+    }
 
     VkSharingMode shareMode = VkSharingMode::VK_SHARING_MODE_EXCLUSIVE;
     std::vector<uint32_t>   queueFamilyIndices;
@@ -993,6 +1520,27 @@ void Harmony::CreateSwapChain() {
         queueFamilyIndices.push_back(choosenQueueIndices.presentFamily.value());
     }
 
+    // the upscale blits into the swapchain image, from an offscreen target of the same format
+    if (dynamicResolution) {
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, surfaceFormat.format, &props);
+
+        const VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+
+        dynamicResolution = (sCaps.surfaceCaps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+                         && (props.optimalTilingFeatures & needed) == needed;
+    }
+
+    // frame capture copies out of the swapchain image
+    if (frameCapture) {
+        swapchainReadback = (sCaps.surfaceCaps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+                         && FrameReadback::BytesPerPixel(surfaceFormat.format) != 0;
+
+        if (!swapchainReadback) {
+            std::cout << "The swapchain can not be read back, no frame capture" << std::endl;
+        }
+    }
+
     // swap chain
     VkSwapchainCreateInfoKHR createInfo {
         VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -1004,7 +1552,7 @@ void Harmony::CreateSwapChain() {
         surfaceFormat.colorSpace,
         extent,
         1,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (dynamicResolution ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0) | (swapchainReadback ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0),
         shareMode,
         static_cast<uint32_t>(queueFamilyIndices.size()),
         queueFamilyIndices.data(),                                          
@@ -1012,20 +1560,24 @@ void Harmony::CreateSwapChain() {
         VkCompositeAlphaFlagBitsKHR::VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,     // composite alpha
         presentMode,                                                        // presentMode
         VK_TRUE,                                                            // clipped
-        VK_NULL_HANDLE,                                                     // old swap chain
+        swapchain,                                                          // old swap chain, on a resize
     };
 
+    // the old swapchain is retired by the caller; its images already presented stay valid
+    // until it is destroyed, but no more can be acquired from it
     result = vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapchain);
     if (result != VK_SUCCESS) {
         throw std::runtime_error("Could not create swap chain!");
     }
 
-    deletionQueue.Append(
-        [ cdevice = device
-        , cswapchain = swapchain ] {
-            vkDestroySwapchainKHR(cdevice, cswapchain, nullptr);
-        }
-    );
+    // resizes retire the swapchain they replace, this goes for the last one
+    if (swapChainImageVec.empty()) {
+        deletionQueue.Append(
+            [&] {
+                vkDestroySwapchainKHR(device, swapchain, nullptr);
+            }
+        );
+    }
 
     result = vkGetSwapchainImagesKHR(device, swapchain, &numImages, nullptr);
     if (result == VK_SUCCESS && numImages) {
@@ -1041,6 +1593,8 @@ void Harmony::CreateSwapChain() {
 }
 
 void Harmony::CreateCommandPoolAndBuffers() {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     // graphics command pool & command buffers
@@ -1071,6 +1625,20 @@ void Harmony::CreateCommandPoolAndBuffers() {
         throw std::runtime_error("Could not allocate command buffer!");
     }
 
+    // the scene's draws, one per slot as the set and draw commands they use are
+    std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> sceneCmdBuffers;
+
+    cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+    result = vkAllocateCommandBuffers(device, &cbAllocInfo, sceneCmdBuffers.data());
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not allocate scene command buffers!");
+    }
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        sceneCommandVec[i].cmdBuffer = sceneCmdBuffers[i];
+    }
+
     deletionQueue.Append(
         [ cdevice = device
         , ccommandPool = commandPool ] {
@@ -1096,6 +1664,8 @@ void Harmony::CreateCommandPoolAndBuffers() {
 }
 
 void Harmony::CreateSyncObjects() {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     imageReadyVec.resize(MAX_FRAMES_IN_FLIGHT);
@@ -1144,32 +1714,97 @@ void Harmony::CreateSyncObjects() {
             imageReadyVec.clear();
         }
     );
-}
 
-void Harmony::CreateImageViews() {
-    swapChainImageViewVec.resize(swapChainImageVec.size());
+    // retired objects go with the fences that tell when they are unused
+    retireQueue.Create(device, MAX_FRAMES_IN_FLIGHT);
 
-    for (size_t i = 0; i < swapChainImageViewVec.size(); ++i) {
-        swapChainImageViewVec[i] = CreateImageView(swapChainImageVec[i], swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+    deletionQueue.Append([&] { retireQueue.Flush(); });
+}
+
+uint32_t Harmony::GraphicsTimestampBits() {
+    if (!chosenDeviceProps.properties.limits.timestampComputeAndGraphics) {
+        return 0;
     }
 
-    deletionQueue.Append(
-        [&] {
-            for (size_t i = 0; i < swapChainImageViewVec.size(); ++i) {
-                vkDestroyImageView(device, swapChainImageViewVec[i], nullptr);
-            }
+    uint32_t qfCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &qfCount, nullptr);
 
-            swapChainImageViewVec.clear();
-        });
+    std::vector<VkQueueFamilyProperties> queueFamilyProps(qfCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &qfCount, queueFamilyProps.data());
+
+    return queueFamilyProps[choosenQueueIndices.graphicsFamily.value()].timestampValidBits;
 }
 
-void Harmony::CreateRenderPass() {
-    VkResult result;
+void Harmony::CreateGpuProfiler() {
+    CPU_FUNCTION_ZONE();
 
-    VkAttachmentDescription renderTarget {
-        0,
-        swapChainImageFormat,                    // format
-        VK_SAMPLE_COUNT_1_BIT,                   // samples 
+    // one query range per command buffer; the feature was enabled with the rest of choosenDeviceFeatures.
+    // Statistics are only reported with --gpu-profile, and keep the scene's draws from being reused
+    gpuProfiler.Create(device, MAX_FRAMES_IN_FLIGHT, chosenDeviceProps.properties.limits.timestampPeriod, timestampBits,
+                       gpuProfile && choosenDeviceFeatures.features.pipelineStatisticsQuery == VK_TRUE);
+
+    reuseSceneCommands = !gpuProfiler.HasStatistics();
+
+    if (!gpuProfiler.IsEnabled()) {
+        std::cout << "No GPU timestamps on the graphics queue, profiling and dynamic resolution are off" << std::endl;
+        return;
+    }
+
+    if (!gpuTracePath.empty()) {
+        gpuProfiler.StartTrace(GPU_TRACE_FRAMES);
+    }
+
+    deletionQueue.Append([&] { gpuProfiler.Destroy(); });
+}
+
+void Harmony::CreateFrameReadback() {
+    CPU_FUNCTION_ZONE();
+
+    if (!frameCapture) {
+        return;
+    }
+
+    // a buffer per frame in flight and per worker encoding, so capture only drops frames
+    // when encoding falls behind rendering
+    frameReadback.Create(device, memoryProps, MAX_FRAMES_IN_FLIGHT, MAX_FRAMES_IN_FLIGHT + threadPool.ThreadCount(), threadPool,
+                         [this](const ReadbackImage& image) { frameCapture->Write(image); });
+
+    deletionQueue.Append([&] { frameReadback.Destroy(); });
+}
+
+void Harmony::CreateImageViews() {
+    CPU_FUNCTION_ZONE();
+
+    const bool first = swapChainImageViewVec.empty();
+
+    swapChainImageViewVec.resize(swapChainImageVec.size());
+
+    for (size_t i = 0; i < swapChainImageViewVec.size(); ++i) {
+        swapChainImageViewVec[i] = CreateImageView(swapChainImageVec[i], swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+
+    // resizes retire the views they replace, this goes for the last ones
+    if (!first) {
+        return;
+    }
+
+    deletionQueue.Append(
+        [&] {
+            for (size_t i = 0; i < swapChainImageViewVec.size(); ++i) {
+                vkDestroyImageView(device, swapChainImageViewVec[i], nullptr);
+            }
+
+            swapChainImageViewVec.clear();
+        });
+}
+
+void Harmony::CreateRenderPass() {
+    VkResult result;
+
+    VkAttachmentDescription renderTarget {
+        0,
+        swapChainImageFormat,                    // format
+        VK_SAMPLE_COUNT_1_BIT,                   // samples 
         VK_ATTACHMENT_LOAD_OP_CLEAR,             // clear on load  
         VK_ATTACHMENT_STORE_OP_STORE,            // store to mem on exit of pass
         VK_ATTACHMENT_LOAD_OP_DONT_CARE,         // not using stencil
@@ -1251,9 +1886,11 @@ void Harmony::CreateRenderPass() {
 }
 
 void Harmony::CreateUniformBuffer() {
+    CPU_FUNCTION_ZONE();
+
     uboVec.resize(MAX_FRAMES_IN_FLIGHT);
 
-    VkDeviceSize uboSize = sizeof(glm::mat4);
+    VkDeviceSize uboSize = sizeof(UniformBufferObject);
 
     for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
         auto info = CreateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uboSize);
@@ -1267,8 +1904,54 @@ void Harmony::CreateUniformBuffer() {
     }
 }
 
+void Harmony::LoadMesh(const LaunchOptions& options) {
+    CPU_FUNCTION_ZONE();
+
+    if (!options.meshPath.empty()) {
+        mesh = MeshLoader::Load(options.meshPath);
+    }
+    else {
+        mesh.vertices.assign(std::begin(vertices), std::end(vertices));
+        mesh.indices.assign(std::begin(indices), std::end(indices));
+        mesh.ComputeBounds();
+    }
+
+    if (options.optimizeMesh) {
+        MeshOptimizer::PrintReport(MeshOptimizer::Optimize(mesh));
+    }
+
+    // coarser levels are appended to mesh.indices and share the vertices
+    lods         = MeshSimplifier::BuildLodChain(mesh, options.lodCount);
+    lodThreshold = options.lodThreshold;
+    MeshSimplifier::PrintLods(lods);
+
+    VertexQuantizer::ErrorReport quantError;
+    vertexEncoding = VertexQuantizer::Choose(mesh, options.vertexFormat, 1e-4f, &quantError);
+    VertexQuantizer::PrintReport(vertexEncoding, quantError);
+
+    vertexInput  = vertexEncoding.GetInputDescription();
+    depthPrepass = options.depthPrepass;
+
+    // cut after reordering so every meshlet keeps the optimized triangle order
+    clusterCull  = options.clusterCull;
+    if (clusterCull) {
+        for (MeshLod& lod : lods) {
+            auto lodMeshlets = MeshletBuilder::Build(mesh, lod.firstIndex, lod.indexCount);
+
+            lod.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+            lod.meshletCount = static_cast<uint32_t>(lodMeshlets.size());
+
+            meshlets.insert(meshlets.end(), lodMeshlets.begin(), lodMeshlets.end());
+        }
+
+        MeshletBuilder::PrintStats(MeshletBuilder::Analyze(meshlets));
+    }
+}
+
 void Harmony::CreateVertexBuffer(VkCommandBuffer cmdBuffer) {
-    VkDeviceSize size  = sizeof vertices;
+    CPU_FUNCTION_ZONE();
+
+    VkDeviceSize size  = VertexQuantizer::BufferSize(mesh, vertexEncoding);
 
     vertexBufferInfo  = CreateBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         size);
@@ -1287,18 +1970,25 @@ void Harmony::CreateVertexBuffer(VkCommandBuffer cmdBuffer) {
             throw std::runtime_error("Could not map memory!");
         }
 
-        memcpy_s(pdata, size, vertices, size);
+        // packs every stream straight into staging memory, quantizing when the mesh uses a packed layout
+        VertexQuantizer::Pack(mesh, vertexEncoding, pdata);
 
         vkUnmapMemory(device, stagingBufferInfo.memory);
     }
 
+    for (uint32_t s = 0; s < vertexInput.bindingCount; ++s) {
+        vertexStreamOffsets[s] = VertexQuantizer::StreamOffset(mesh, vertexEncoding, s);
+    }
+
     CopyBuffer(cmdBuffer, stagingBufferInfo.buffer, vertexBufferInfo.buffer, size);
 
-    DestroyBuffer(stagingBufferInfo, true);
+    RetireBuffer(stagingBufferInfo);
 }
 
 void Harmony::CreateIndexBuffer(VkCommandBuffer cmdBuffer) {
-    VkDeviceSize size = sizeof(uint16_t) * 12;
+    CPU_FUNCTION_ZONE();
+
+    VkDeviceSize size = mesh.IndexBufferSize();
 
     indexBufferInfo = CreateBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         size);
@@ -1317,66 +2007,295 @@ void Harmony::CreateIndexBuffer(VkCommandBuffer cmdBuffer) {
             throw std::runtime_error("Could not map memory!");
         }
 
-        memcpy_s(pdata, size, indices, size);
+        // narrowed to 16 bit on the fly when the vertex count allows
+        mesh.WriteIndices(pdata);
 
         vkUnmapMemory(device, stagingBufferInfo.memory);
     }
 
     CopyBuffer(cmdBuffer, stagingBufferInfo.buffer, indexBufferInfo.buffer, size);
 
-    DestroyBuffer(stagingBufferInfo, true);
+    RetireBuffer(stagingBufferInfo);
 }
 
-void Harmony::CreateTextureImageAndView(VkCommandBuffer cmdBuffer) {
-    int texWidth, texHeight, texChannels;
-    VkResult result;
+void Harmony::CreateMeshletBuffer(VkCommandBuffer cmdBuffer) {
+    CPU_FUNCTION_ZONE();
 
-    stbi_uc* pPixels = stbi_load("textures/checkerboard.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    if (!pPixels) {
-        throw std::runtime_error("Could noit load texture!");
+    if (!clusterCull) {
+        return;
     }
 
-    VkDeviceSize imageSize = texWidth * texHeight * 4; // RGBA 
+    VkDeviceSize size = meshlets.size() * sizeof(Meshlet);
 
-    auto stagingBuffer = CreateBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, imageSize);
+    meshletBufferInfo = CreateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        size);
 
-    void *stagingPtr = nullptr;
-    result = vkMapMemory(device, stagingBuffer.memory, 0, imageSize, 0, &stagingPtr);
-    if (result == VK_SUCCESS) {
-        memcpy_s(stagingPtr, imageSize, pPixels, imageSize);
-        vkUnmapMemory(device, stagingBuffer.memory);
+    // destroy when app exits
+    DestroyBuffer(meshletBufferInfo, true);
+
+    auto stagingBufferInfo = CreateBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+        size);
+
+    {
+        void *pdata = nullptr;
+
+        VkResult result = vkMapMemory(device, stagingBufferInfo.memory, 0, size, 0, &pdata);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("Could not map memory!");
+        }
+
+        memcpy_s(pdata, size, meshlets.data(), size);
+
+        vkUnmapMemory(device, stagingBufferInfo.memory);
     }
-    else {
-        throw std::runtime_error("Could not map staging memory!");
+
+    CopyBuffer(cmdBuffer, stagingBufferInfo.buffer, meshletBufferInfo.buffer, size);
+
+    RetireBuffer(stagingBufferInfo);
+}
+
+void Harmony::OpenAssetPack(const std::string& packPath) {
+    CPU_FUNCTION_ZONE();
+
+    if (packPath.empty()) {
+        return;
     }
 
-    stbi_image_free(pPixels);
+    if (GetFileAttributesA(packPath.c_str()) == INVALID_FILE_ATTRIBUTES) {
+        std::cout << "No asset pack at " << packPath << ", reading loose files" << std::endl;
+        return;
+    }
+
+    assetPack.Open(packPath);
+
+    std::cout << "Asset pack: " << packPath << ", " << (assetPack.end() - assetPack.begin()) << " assets" << std::endl;
+}
+
+void Harmony::RequestTextures() {
+    CPU_FUNCTION_ZONE();
+
+    // decoding starts while the device and swapchain are still being created
+    textureLoader = std::make_unique<AsyncTextureLoader>(
+        threadPool,
+        [cphysicalDevice = physicalDevice](VkFormat format, VkFormatFeatureFlags features) {
+            VkFormatProperties props;
+            vkGetPhysicalDeviceFormatProperties(cphysicalDevice, format, &props);
+
+            return (props.optimalTilingFeatures & features) == features;
+        },
+        cpuMips || hostImageCopy,   // a host copy has no command buffer to blit mips in
+        assetPack.IsOpen() ? &assetPack : nullptr
+    );
+
+    textureLoader->Request(texturePath);
+}
+
+void Harmony::CreatePlaceholderTexture(VkCommandBuffer cmdBuffer) {
+    CPU_FUNCTION_ZONE();
+
+    // 4x4 grey checker, sampled until the real texture has been streamed in
+    DecodedTexture placeholder;
+
+    placeholder.path   = "placeholder";
+    placeholder.format = VK_FORMAT_R8G8B8A8_SRGB;
+    placeholder.width  = 4;
+    placeholder.height = 4;
+    placeholder.levels = { { 4, 4, 0, 4 * 4 * 4 } };
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint8_t grey = ((i ^ (i >> 2)) & 1) ? 96 : 160;
+        placeholder.pixels.insert(placeholder.pixels.end(), { grey, grey, grey, 255 });
+    }
+
+    BufferInfo stagingBuffer;
 
-    textureInfo = CreateImage(VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, texWidth, texHeight); 
-    DestroyImage(textureInfo, true);
+    textureInfo = UploadTexture(cmdBuffer, placeholder, stagingBuffer);
 
-    TransitionImage(cmdBuffer, textureInfo.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    CopyBufferToImage(cmdBuffer, stagingBuffer.buffer, textureInfo.image, texWidth, texHeight);
-    TransitionImage(cmdBuffer, textureInfo.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    RetireBuffer(stagingBuffer);
+
+    // whichever texture is current at exit; the ones it replaced are retired as they go
+    deletionQueue.Append(
+        [&] {
+            DestroyImage(textureInfo);
 
-    DestroyBuffer(stagingBuffer, true);
+            for (ImageInfo& info : replacedTextureVec) {
+                DestroyImage(info);
+            }
+        }
+    );
 }
 
-void Harmony::CreateDepthImageAndView() {
+void Harmony::CreateTransientAttachments() {
+    CPU_FUNCTION_ZONE();
+
+    VkResult result;
+
+    if (!transientImageVec.empty()) {
+        RetireTransientAttachments();
+    }
+    else {
+        deletionQueue.Append(
+            [&] {
+                DestroyTransientAttachments();
+            }
+        );
+    }
+
     depthFormat = findSuitableFormat(
         {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
         VK_IMAGE_TILING_OPTIMAL,
         VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 
-    depthInfo = CreateImage(depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT, swapChainImageExtent.width, swapChainImageExtent.height);
-    DestroyImage(depthInfo, true);
+    struct TransientTarget {
+        ImageInfo*         info;
+        VkFormat           format;
+        VkImageUsageFlags  usageFlags;
+        VkImageAspectFlags aspectFlags;
+        uint32_t           firstPass;
+        uint32_t           lastPass;
+    };
+
+    // full swapchain size; dynamic resolution renders into a corner of them
+    std::vector<TransientTarget> targets = {
+        { &depthInfo, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT, ScenePass, ScenePass },
+    };
+
+    if (dynamicResolution) {
+        targets.push_back({ &sceneColorInfo, swapChainImageFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_IMAGE_ASPECT_COLOR_BIT, ScenePass, UpscalePass });
+    }
+
+    const VkImageUsageFlags attachmentOnly = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+    // targets that are never stored can live in lazily allocated memory, the rest can't;
+    // each group is one allocation
+    for (bool lazyGroup : { true, false }) {
+        std::vector<const TransientTarget*> group;
+        std::vector<TransientMemory::Block> blocks;
+        uint32_t                            typeBits      = ~0u;
+        VkDeviceSize                        unaliasedSize = 0;
+
+        for (const TransientTarget& target : targets) {
+            if (((target.usageFlags & ~attachmentOnly) == 0) != lazyGroup) {
+                continue;
+            }
+
+            VkImageCreateInfo createInfo {
+                VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                nullptr,
+                0, // flags
+                VK_IMAGE_TYPE_2D,
+                target.format,
+                VkExtent3D { swapChainImageExtent.width, swapChainImageExtent.height, 1 },
+                1,
+                1,
+                VK_SAMPLE_COUNT_1_BIT,
+                VK_IMAGE_TILING_OPTIMAL,
+                target.usageFlags | (lazyGroup ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0),
+                VK_SHARING_MODE_EXCLUSIVE,
+                0,
+                nullptr,
+                VK_IMAGE_LAYOUT_UNDEFINED
+            };
+
+            result = vkCreateImage(device, &createInfo, nullptr, &target.info->image);
+            if (result != VK_SUCCESS) {
+                throw std::runtime_error("Could not create transient image!");
+            }
+
+            VkMemoryRequirements memRequirements;
+            vkGetImageMemoryRequirements(device, target.info->image, &memRequirements);
+
+            group.push_back(&target);
+            blocks.push_back({ memRequirements.size, memRequirements.alignment, target.firstPass, target.lastPass });
+
+            typeBits      &= memRequirements.memoryTypeBits;
+            unaliasedSize += memRequirements.size;
+        }
+
+        if (group.empty()) {
+            continue;
+        }
+
+        std::vector<uint64_t> offsets;
+        VkDeviceSize          size = TransientMemory::Place(blocks, offsets);
+
+        // lazily allocated memory is only backed when a tiler has to spill the attachment
+        const bool lazy = lazyGroup && HasMemoryType(typeBits, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+
+        VkMemoryAllocateInfo allocInfo {
+            VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            nullptr,
+            size,
+            SearchMemoryType(typeBits, lazy ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+        };
+
+        VkDeviceMemory memory;
+
+        result = vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("Could not allocate transient memory!");
+        }
+
+        transientMemoryVec.push_back(memory);
+
+        for (size_t i = 0; i < group.size(); ++i) {
+            ImageInfo* info = group[i]->info;
+
+            result = vkBindImageMemory(device, info->image, memory, offsets[i]);
+            if (result != VK_SUCCESS) {
+                throw std::runtime_error("Could not bind transient image memory!");
+            }
+
+            info->memory = memory;
+            info->view   = CreateImageView(info->image, group[i]->format, group[i]->aspectFlags);
+
+            transientImageVec.push_back(info);
+        }
+
+        std::cout << "Transient attachments: " << size / 1024 << " KiB for " << unaliasedSize / 1024 << " KiB of images"
+                  << (lazy ? ", lazily allocated" : "") << std::endl;
+    }
+}
+
+void Harmony::DestroyTransientAttachments() {
+    for (ImageInfo* info : transientImageVec) {
+        vkDestroyImageView(device, info->view, nullptr);
+        vkDestroyImage(device, info->image, nullptr);
+
+        *info = {};
+    }
+
+    transientImageVec.clear();
+
+    for (VkDeviceMemory memory : transientMemoryVec) {
+        vkFreeMemory(device, memory, nullptr);
+    }
+
+    transientMemoryVec.clear();
+}
+
+void Harmony::RetireTransientAttachments() {
+    const uint32_t slot = static_cast<uint32_t>(currentFrame);
+
+    for (ImageInfo* info : transientImageVec) {
+        retireQueue.RetireImageView(slot, frameNumber, info->view);
+        retireQueue.RetireImage(slot, frameNumber, info->image);
+
+        *info = {};
+    }
+
+    transientImageVec.clear();
 
-    auto cmdBuffer = BeginOneTimeCommands();
-    TransitionImage(cmdBuffer, depthInfo.image, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-    EndOneTimeCommands(cmdBuffer);
+    for (VkDeviceMemory memory : transientMemoryVec) {
+        retireQueue.RetireMemory(slot, frameNumber, memory);
+    }
+
+    transientMemoryVec.clear();
 }
 
 void Harmony::CreateTextureSampler() {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     VkSamplerCreateInfo createInfo {
@@ -1394,8 +2313,8 @@ void Harmony::CreateTextureSampler() {
         chosenDeviceProps.properties.limits.maxSamplerAnisotropy,
         VK_FALSE,
         VK_COMPARE_OP_ALWAYS,
-        0.0f,
-        0.0f,
+        0.0f,                           // minLod
+        VK_LOD_CLAMP_NONE,              // maxLod, the view limits it to whatever chain is bound
         VK_BORDER_COLOR_INT_OPAQUE_BLACK,
         VK_FALSE
     };
@@ -1414,6 +2333,8 @@ void Harmony::CreateTextureSampler() {
 }
 
 void Harmony::CreateDescriptorPoolAndSets() {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     std::array<VkDescriptorPoolSize, 2> poolSizes = {
@@ -1477,32 +2398,9 @@ void Harmony::CreateDescriptorPoolAndSets() {
         };
 
         std::array<VkWriteDescriptorSet, 2> writeDescs = {
-            {
-                {
-                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    nullptr,
-                    descSetVec[i],
-                    0,
-                    0,
-                    1,
-                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    nullptr,
-                    &buffInfo,
-                    nullptr
-                },
-                {
-                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    nullptr,
-                    descSetVec[i],
-                    1,
-                    0,
-                    1,
-                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    &imageInfo,
-                    nullptr,
-                    nullptr
-                }
-        } };
+            BufferDescriptorWrite(descSetVec[i], 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &buffInfo),
+            ImageDescriptorWrite(descSetVec[i], 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &imageInfo)
+        };
 
         vkUpdateDescriptorSets(device, 2, writeDescs.data(), 0, nullptr);
     }
@@ -1549,6 +2447,8 @@ void Harmony::CreateFrameBuffers() {
 }
 
 void Harmony::CreateDescriptorSetLayout() {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     VkDescriptorSetLayoutBinding uboLayoutBinding {
@@ -1591,52 +2491,66 @@ void Harmony::CreateDescriptorSetLayout() {
     );
 }
 
-void Harmony::CreateGraphicsPipeline() {
-    CHAR currentDirectory[MAX_PATH + 1];
-    VkResult result;
+VkShaderModule Harmony::CreateShaderModule(const char* fileName) {
+    std::vector<char> code;
+    const uint32_t*   pCode    = nullptr;
+    size_t            codeSize = 0;
 
-    GetCurrentDirectory(MAX_PATH, currentDirectory);
+    const AssetPackEntry* entry = assetPack.IsOpen() ? assetPack.Find(std::string("shaders/") + fileName) : nullptr;
 
-    std::string vPath(currentDirectory);
-    vPath += "\\shaders\\shader.vert.spv";
-    auto vShader = readShaderFile(vPath);
+    if (entry && entry->type == AssetType::Spirv) {
+        // uncompressed payloads are 64 KiB aligned in the mapping and go to the driver as is
+        pCode    = reinterpret_cast<const uint32_t*>(assetPack.Data(*entry));
+        codeSize = static_cast<size_t>(entry->size);
 
-    std::string fPath(currentDirectory);
-    fPath += "\\shaders\\shader.frag.spv";
-    auto fShader = readShaderFile(fPath);
+        if (!pCode) {
+            code.resize(codeSize);
+            assetPack.Read(*entry, reinterpret_cast<uint8_t*>(code.data()));
+        }
+    }
+    else {
+        CHAR currentDirectory[MAX_PATH + 1];
 
-    VkShaderModule vShaderModule, fShaderModule;
+        GetCurrentDirectory(MAX_PATH, currentDirectory);
 
-    {
-        VkShaderModuleCreateInfo vCreateInfo {
-            VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            nullptr,
-            0,
-            static_cast<uint32_t>(vShader.size()),
-            reinterpret_cast<uint32_t*>(vShader.data())
-        };
+        std::string path(currentDirectory);
+        path += "\\shaders\\";
+        path += fileName;
+        code = readShaderFile(path);
+        codeSize = code.size();
+    }
 
-        result = vkCreateShaderModule(device, &vCreateInfo, nullptr, &vShaderModule);
-        if (result != VK_SUCCESS) {
-            throw std::runtime_error("Could not create vertex shader module!");
-        }
+    if (!pCode) {
+        pCode = reinterpret_cast<const uint32_t*>(code.data());
     }
 
-    {
-        VkShaderModuleCreateInfo fCreateInfo {
-            VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            nullptr,
-            0,
-            static_cast<uint32_t>(fShader.size()),
-            reinterpret_cast<uint32_t*>(fShader.data())
-        };
+    VkShaderModuleCreateInfo createInfo {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        nullptr,
+        0,
+        codeSize,
+        pCode
+    };
 
-        result = vkCreateShaderModule(device, &fCreateInfo, nullptr, &fShaderModule);
-        if (result != VK_SUCCESS) {
-            throw std::runtime_error("Could not create fragment shader module!");
-        }
+    VkShaderModule shaderModule;
+
+    VkResult result = vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not create shader module!");
     }
 
+    return shaderModule;
+}
+
+void Harmony::CreateGraphicsPipeline() {
+    CPU_FUNCTION_ZONE();
+
+    VkResult result;
+
+    VkShaderModule vShaderModule = CreateShaderModule("shader.vert.spv");
+    VkShaderModule fShaderModule = CreateShaderModule("shader.frag.spv");
+    VkShaderModule dShaderModule = CreateShaderModule("depth.vert.spv");
+
     VkPipelineShaderStageCreateInfo vShaderStageCreateInfo {
         VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
         nullptr,
@@ -1659,6 +2573,17 @@ void Harmony::CreateGraphicsPipeline() {
 
     VkPipelineShaderStageCreateInfo shaderStagesCreateInfos[] = { vShaderStageCreateInfo, fShaderStageCreateInfo };
 
+    // depth prepass has no fragment shader, only depth is written
+    VkPipelineShaderStageCreateInfo dShaderStageCreateInfo {
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        nullptr,
+        0,
+        VkShaderStageFlagBits::VK_SHADER_STAGE_VERTEX_BIT,
+        dShaderModule,
+        "main",
+        nullptr    // no specialization constants
+    };
+
     // dynamic states
     std::vector<VkDynamicState> dynamicStates = {
         VK_DYNAMIC_STATE_VIEWPORT,
@@ -1683,17 +2608,27 @@ void Harmony::CreateGraphicsPipeline() {
         nullptr  // specified in cmd buffer
     };
 
-    auto vertexBindingDescription = Vertex::GetInputBindingDescription();
-    auto vertexAttributeDescription = Vertex::GetInputAttributeDescriptionArray();
-
     VkPipelineVertexInputStateCreateInfo vfStateCreateInfo {
         VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         nullptr,
         0,
-        1,  // vertexBindingDescriptionCount
-        &vertexBindingDescription,
-        static_cast<uint32_t>(vertexAttributeDescription.size()),  // vertexAttributeDescriptionCount
-        vertexAttributeDescription.data()
+        vertexInput.bindingCount,  // vertexBindingDescriptionCount
+        vertexInput.bindings.data(),
+        vertexInput.attributeCount,  // vertexAttributeDescriptionCount
+        vertexInput.attributes.data()
+    };
+
+    // prepass fetches the position stream and nothing else
+    VertexInputDescription positionInput = vertexInput.Streams(VERTEX_STREAM_POSITION + 1);
+
+    VkPipelineVertexInputStateCreateInfo dVfStateCreateInfo {
+        VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        nullptr,
+        0,
+        positionInput.bindingCount,  // vertexBindingDescriptionCount
+        positionInput.bindings.data(),
+        positionInput.attributeCount,  // vertexAttributeDescriptionCount
+        positionInput.attributes.data()
     };
 
     VkPipelineInputAssemblyStateCreateInfo iaStateCreateInfo {
@@ -1747,6 +2682,14 @@ void Harmony::CreateGraphicsPipeline() {
         1.0f                  // max depth bound
     };
 
+    // after the prepass only the visible surface passes, and depth is already final
+    VkPipelineDepthStencilStateCreateInfo dDsStateCreateInfo = dsStateCreateInfo;
+
+    if (depthPrepass) {
+        dsStateCreateInfo.depthWriteEnable = VK_FALSE;
+        dsStateCreateInfo.depthCompareOp   = VK_COMPARE_OP_EQUAL;
+    }
+
     VkPipelineColorBlendAttachmentState colorBlendAttachmentState {
         VK_FALSE, // blendEnable
         VK_BLEND_FACTOR_ONE,  // srcColorBlendFactor
@@ -1769,20 +2712,23 @@ void Harmony::CreateGraphicsPipeline() {
         { 0.0f, 0.0f, 0.0f, 0.0f }  // blend constants
     };
 
-    VkPushConstantRange pushConstantRange {
-        VK_SHADER_STAGE_VERTEX_BIT,
-        0,
-        sizeof(PushConstant)
-    };
+    // prepass runs inside the same rendering as the colour pass, so it declares the
+    // colour attachment but never writes it
+    VkPipelineColorBlendAttachmentState dColorBlendAttachmentState = colorBlendAttachmentState;
+    dColorBlendAttachmentState.colorWriteMask = 0;
 
+    VkPipelineColorBlendStateCreateInfo dCbStateCreateInfo = cbStateCreateInfo;
+    dCbStateCreateInfo.pAttachments = &dColorBlendAttachmentState;
+
+    // no push constants, the camera is in the UBO like the rest of the frame's data
     VkPipelineLayoutCreateInfo plCreateInfo {
         VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         nullptr,
         0,
         1,                    // setLayoutCOunt
         &descriptorSetLayout, // pSetLayouts
-        1,                    // pushConstantRangeCount
-        &pushConstantRange,   // pPushConstantRanges
+        0,                    // pushConstantRangeCount
+        nullptr,              // pPushConstantRanges
     };
 
     result = vkCreatePipelineLayout(device, &plCreateInfo, nullptr, &pipelineLayout);
@@ -1843,13 +2789,35 @@ void Harmony::CreateGraphicsPipeline() {
         throw std::runtime_error("Could not create graphics pipeline!");
     }
 
-#ifdef __DUMP_SHADER_INFO__
-    // executable properties
-    {
-        VkPipelineInfoKHR plInfo {
-            VK_STRUCTURE_TYPE_PIPELINE_INFO_KHR,
-            nullptr,
-            graphicsPipeline
+    if (depthPrepass) {
+        VkGraphicsPipelineCreateInfo dPipelineCreateInfo = pipelineCreateInfo;
+
+        dPipelineCreateInfo.stageCount          = 1;
+        dPipelineCreateInfo.pStages             = &dShaderStageCreateInfo;
+        dPipelineCreateInfo.pVertexInputState   = &dVfStateCreateInfo;
+        dPipelineCreateInfo.pDepthStencilState  = &dDsStateCreateInfo;
+        dPipelineCreateInfo.pColorBlendState    = &dCbStateCreateInfo;
+
+        result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &dPipelineCreateInfo, nullptr, &depthPrepassPipeline);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("Could not create depth prepass pipeline!");
+        }
+
+        deletionQueue.Append(
+            [ cdevice = device
+            , cpipeline = depthPrepassPipeline ] {
+                vkDestroyPipeline(cdevice, cpipeline, nullptr);
+            }
+        );
+    }
+
+#ifdef __DUMP_SHADER_INFO__
+    // executable properties
+    {
+        VkPipelineInfoKHR plInfo {
+            VK_STRUCTURE_TYPE_PIPELINE_INFO_KHR,
+            nullptr,
+            graphicsPipeline
         };
 
         VkPipelineExecutablePropertiesKHR plProps {
@@ -1907,58 +2875,302 @@ void Harmony::CreateGraphicsPipeline() {
         }
     );
 
+    vkDestroyShaderModule(device, dShaderModule, nullptr);
     vkDestroyShaderModule(device, fShaderModule, nullptr);
     vkDestroyShaderModule(device, vShaderModule, nullptr);
 }
 
+void Harmony::CreateClusterCulling() {
+    CPU_FUNCTION_ZONE();
+
+    if (!clusterCull) {
+        return;
+    }
+
+    VkResult result;
+    uint32_t meshletCount = static_cast<uint32_t>(meshlets.size());
+
+    // one draw command array per frame slot, the cull shader rewrites it every frame
+    drawCommandBufferVec.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        drawCommandBufferVec[i] = CreateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            VkDeviceSize(meshletCount) * sizeof(VkDrawIndexedIndirectCommand));
+
+        // delete at app exit
+        DestroyBuffer(drawCommandBufferVec[i], true);
+    }
+
+    std::array<VkDescriptorSetLayoutBinding, 2> layoutBinding = {
+        {
+            { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },  // meshlets
+            { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }   // draw commands
+        }
+    };
+
+    VkDescriptorSetLayoutCreateInfo dsCreateInfo {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        nullptr,
+        0,
+        static_cast<uint32_t>(layoutBinding.size()),
+        layoutBinding.data()
+    };
+
+    result = vkCreateDescriptorSetLayout(device, &dsCreateInfo, nullptr, &cullDescriptorSetLayout);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not create cull descriptor set layout!");
+    }
+
+    deletionQueue.Append(
+        [ cdevice = device,
+          clayout = cullDescriptorSetLayout ]
+        {
+            vkDestroyDescriptorSetLayout(cdevice, clayout, nullptr);
+        }
+    );
+
+    VkDescriptorPoolSize poolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * MAX_FRAMES_IN_FLIGHT };
+
+    VkDescriptorPoolCreateInfo poolCreateInfo {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        nullptr,
+        0,
+        MAX_FRAMES_IN_FLIGHT,
+        1,
+        &poolSize
+    };
+
+    result = vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &cullDescriptorPool);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not create cull descriptor pool!");
+    }
+
+    deletionQueue.Append(
+        [ cdevice = device,
+          cpool = cullDescriptorPool ]
+        {
+            vkDestroyDescriptorPool(cdevice, cpool, nullptr);
+        }
+    );
+
+    cullDescSetVec.resize(MAX_FRAMES_IN_FLIGHT);
+
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, cullDescriptorSetLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        nullptr,
+        cullDescriptorPool,
+        MAX_FRAMES_IN_FLIGHT,
+        layouts.data()
+    };
+
+    result = vkAllocateDescriptorSets(device, &allocInfo, cullDescSetVec.data());
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not allocate cull descriptor sets!");
+    }
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        VkDescriptorBufferInfo meshletInfo { meshletBufferInfo.buffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo drawInfo    { drawCommandBufferVec[i].buffer, 0, VK_WHOLE_SIZE };
+
+        std::array<VkWriteDescriptorSet, 2> writeDescs = {
+            BufferDescriptorWrite(cullDescSetVec[i], 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &meshletInfo),
+            BufferDescriptorWrite(cullDescSetVec[i], 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &drawInfo)
+        };
+
+        vkUpdateDescriptorSets(device, 2, writeDescs.data(), 0, nullptr);
+    }
+
+    VkPushConstantRange pushConstantRange {
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(CullConstants)
+    };
+
+    VkPipelineLayoutCreateInfo plCreateInfo {
+        VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        nullptr,
+        0,
+        1,                        // setLayoutCount
+        &cullDescriptorSetLayout, // pSetLayouts
+        1,                        // pushConstantRangeCount
+        &pushConstantRange,       // pPushConstantRanges
+    };
+
+    result = vkCreatePipelineLayout(device, &plCreateInfo, nullptr, &cullPipelineLayout);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not create cull pipeline layout!");
+    }
+
+    deletionQueue.Append(
+        [ cdevice = device
+        , cpl = cullPipelineLayout ] {
+            vkDestroyPipelineLayout(cdevice, cpl, nullptr);
+        }
+    );
+
+    VkShaderModule cShaderModule = CreateShaderModule("cull.comp.spv");
+
+    VkComputePipelineCreateInfo pipelineCreateInfo {
+        VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        nullptr,
+        0,
+        {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            nullptr,
+            0,
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            cShaderModule,
+            "main",
+            nullptr    // no specialization constants
+        },
+        cullPipelineLayout,
+        VK_NULL_HANDLE,
+        -1
+    };
+
+    result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &cullPipeline);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not create cull pipeline!");
+    }
+
+    deletionQueue.Append(
+        [ cdevice = device
+        , cpipeline = cullPipeline ] {
+            vkDestroyPipeline(cdevice, cpipeline, nullptr);
+        }
+    );
+
+    vkDestroyShaderModule(device, cShaderModule, nullptr);
+}
+
+void Harmony::CreateScene() {
+    CPU_FUNCTION_ZONE();
+
+    // pivot spins about Y, the pyramid bobs up & down in the pivot's space
+    pyramidPivotNode = scene.AddNode(Scene::INVALID_NODE);
+    pyramidNode      = scene.AddNode(pyramidPivotNode);
+
+    // loaded meshes come in any size, fit them into the pyramid's unit footprint (base on y = 0)
+    Scene::Transform fit;
+    {
+        float extent = std::max({ mesh.boundsMax[0] - mesh.boundsMin[0],
+                                  mesh.boundsMax[1] - mesh.boundsMin[1],
+                                  mesh.boundsMax[2] - mesh.boundsMin[2], 1e-6f });
+        float scale  = 1.0f / extent;
+
+        fit.scale       = glm::vec3(scale);
+        fit.translation = glm::vec3(
+            -0.5f * (mesh.boundsMin[0] + mesh.boundsMax[0]) * scale,
+            -mesh.boundsMin[1] * scale,
+            -0.5f * (mesh.boundsMin[2] + mesh.boundsMax[2]) * scale);
+    }
+
+    meshNode = scene.AddNode(pyramidNode, fit);
+
+    // quantized positions are stored in [-1, 1], expand them back to object space
+    Scene::Transform dequant;
+    dequant.translation = glm::vec3(vertexEncoding.positionBias[0], vertexEncoding.positionBias[1], vertexEncoding.positionBias[2]);
+    dequant.scale       = glm::vec3(vertexEncoding.positionScale[0], vertexEncoding.positionScale[1], vertexEncoding.positionScale[2]);
+
+    meshDequantNode = scene.AddNode(meshNode, dequant);
+
+    scene.UpdateTransforms();
+}
+
 #pragma endregion
 /////////////////////////////////////////////////////////////////////////////////////////////
 #pragma region Rendering
 
-void Harmony::UpdateUbo(uint32_t imageIndex) {
+void Harmony::UpdateUbo(uint32_t slot) {
+    CPU_FUNCTION_ZONE();
+
     static auto epoch = std::chrono::high_resolution_clock::now();
 
     auto current = std::chrono::high_resolution_clock::now();
     float time   = std::chrono::duration<float, std::chrono::seconds::period>( current - epoch ).count();
 
-    auto model = glm::rotate(
-        glm::mat4(1.0f),            // identity
+    if (benchmark) {
+        time = benchmark->Time();
+    }
+
+    Scene::Transform pivot;
+    pivot.rotation = glm::angleAxis(
         time * glm::radians(90.0f), // angle
         glm::vec3(0.0f, 1.0f, 0.0f) // which axis to rotate?
     );
 
-    float yDisplacement = (glm::sin(time * 5) * 0.25f) - 0.25f;
+    Scene::Transform bob;
+    bob.translation = glm::vec3(0.0f, (glm::sin(time * 5) * 0.25f) - 0.25f, 0.0f);
 
-    model = glm::translate(model, glm::vec3(0.0f, yDisplacement, 0.0f));
+    scene.SetLocalTransform(pyramidPivotNode, pivot);
+    scene.SetLocalTransform(pyramidNode, bob);
 
-    auto view  = glm::lookAt(
-        glm::vec3(0.0f, 0.25f, -1.0f), // eye position 
-        glm::vec3(0.0f, 0.0f, 0.0f),  // looking at 
-        glm::vec3(0.0f, 1.0f, 0.0f)   // up vector
-    );
+    // only subtrees touched above get recomputed
+    scene.UpdateTransforms();
 
-    auto proj  = glm::perspective(
-        glm::radians(70.0f),         // fov
-        float(swapChainImageExtent.width) / swapChainImageExtent.height, // aspect ratio
-        0.1f,                       // near 
-        20.0f                       // far
-    );
+    const glm::mat4& model = scene.GetWorldMatrix(meshDequantNode);
 
-    // https://github.com/LunarG/VulkanSamples/blob/master/Sample-Programs/Hologram/Hologram.cpp
-    // vulkan has inverted Y and half Z
-    const glm::mat4 clip = {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0, -1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 0.5f, 0.5f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
+    auto view  = Camera::View();
+    auto proj  = Camera::Projection(float(swapChainImageExtent.width) / swapChainImageExtent.height);
+
+    const glm::mat4 viewProj = Camera::Clip() * proj * view;
+
+    uint32_t lod = SelectLod(scene.GetWorldMatrix(meshNode), view, proj);
+    lodVec[slot] = lod;
+
+    lodTriangleSum += lods[lod].indexCount / 3;
+    lodFrameCount++;
 
-    pushConstantVec[imageIndex] = { clip * proj * view };
+    if (clusterCull) {
+        // frustum planes and eye in the mesh's float object space, where meshlet bounds live
+        const glm::mat4& meshToWorld = scene.GetWorldMatrix(meshNode);
 
-    memcpy_s( uboVec[imageIndex].cpuVA, sizeof(model), &model, sizeof(model));
+        CullConstants& cull = cullConstantVec[slot];
+
+        Camera::FrustumPlanes(viewProj * meshToWorld, cull.planes);
+
+        cull.cameraPosition = glm::vec3(glm::inverse(view * meshToWorld)[3]);
+        cull.meshletCount   = lods[lod].meshletCount;
+        cull.firstMeshlet   = lods[lod].firstMeshlet;
+    }
+
+    UniformBufferObject ubo { model, viewProj };
+
+    memcpy_s( uboVec[slot].cpuVA, sizeof(ubo), &ubo, sizeof(ubo));
+}
+
+uint32_t Harmony::SelectLod(const glm::mat4& meshToWorld, const glm::mat4& view, const glm::mat4& proj) const {
+    // bounding sphere of the mesh in view space
+    glm::vec3 center = 0.5f * (glm::vec3(mesh.boundsMin[0], mesh.boundsMin[1], mesh.boundsMin[2])
+                             + glm::vec3(mesh.boundsMax[0], mesh.boundsMax[1], mesh.boundsMax[2]));
+    float     radius = glm::length(glm::vec3(mesh.boundsMax[0], mesh.boundsMax[1], mesh.boundsMax[2]) - center);
+
+    float scale = std::max({ glm::length(glm::vec3(meshToWorld[0])),
+                             glm::length(glm::vec3(meshToWorld[1])),
+                             glm::length(glm::vec3(meshToWorld[2])) });
+
+    glm::vec4 viewCenter = view * meshToWorld * glm::vec4(center, 1.0f);
+
+    // nearest point of the sphere, never closer than the near plane
+    float distance = std::max(-viewCenter.z - radius * scale, 0.1f);
+
+    // proj[1][1] is cot(fov / 2): world units at that distance to pixels
+    float pixelsPerUnit = proj[1][1] * 0.5f * renderExtent.height / distance;
+
+    for (uint32_t i = static_cast<uint32_t>(lods.size()) - 1; i > 0; --i) {
+        if (lods[i].error * scale * pixelsPerUnit <= lodThreshold) {
+            return i;
+        }
+    }
+
+    return 0;
 }
 
 void Harmony::RecordCommandBuffer(VkCommandBuffer cmdBuffer, uint32_t imageIndex) {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     VkCommandBufferBeginInfo beginInfo {
@@ -1973,6 +3185,89 @@ void Harmony::RecordCommandBuffer(VkCommandBuffer cmdBuffer, uint32_t imageIndex
         throw std::runtime_error("Could not begin command buffer!");
     }
 
+    // the swapchain image is cleared, so whatever it held is discarded; depth is transient
+    // and only ordered after the previous frame's depth writes; this slot's draw commands
+    // were last read before its fence signalled
+    frameGraph.Reset();
+
+    // per frame state belongs to the slot, only the swapchain's own objects go by image
+    const uint32_t slot = static_cast<uint32_t>(currentFrame);
+
+    gpuProfiler.BeginFrame(cmdBuffer, slot);
+
+    // at full scale the scene goes straight to the swapchain image and nothing is blitted
+    const bool upscale = renderExtent.width != swapChainImageExtent.width || renderExtent.height != swapChainImageExtent.height;
+
+    auto swapchainImage = frameGraph.ImportImage(swapChainImageVec[imageIndex], VK_IMAGE_ASPECT_COLOR_BIT, ResourceAccess::SwapchainAcquire);
+    auto depthImage     = frameGraph.ImportTransientImage(depthInfo.image, DepthAspectFlags(), ResourceAccess::DepthAttachmentWrite);
+    auto texture        = frameGraph.ImportImage(textureInfo.image, VK_IMAGE_ASPECT_COLOR_BIT, ResourceAccess::FragmentShaderSample, VK_REMAINING_MIP_LEVELS);
+    auto drawCommands   = RenderGraph::Resource(0);
+
+    if (clusterCull) {
+        drawCommands = frameGraph.ImportBuffer(drawCommandBufferVec[slot].buffer, ResourceAccess::None);
+
+        uint32_t cullPass = frameGraph.AddPass("meshlet cull", [this, slot](VkCommandBuffer cmd) { RecordCullPass(cmd, slot); });
+        frameGraph.Use(cullPass, drawCommands, ResourceAccess::ComputeShaderWrite);
+    }
+
+    // the scene colour is written over by every frame that upscales, the last one read it
+    auto sceneColor = upscale ? frameGraph.ImportTransientImage(sceneColorInfo.image, VK_IMAGE_ASPECT_COLOR_BIT, ResourceAccess::TransferRead) : swapchainImage;
+    auto colorView  = upscale ? sceneColorInfo.view : swapChainImageViewVec[imageIndex];
+
+    uint32_t scenePass = frameGraph.AddPass("scene", [this, slot, colorView](VkCommandBuffer cmd) { RecordScenePass(cmd, slot, colorView); });
+    frameGraph.Use(scenePass, sceneColor, ResourceAccess::ColorAttachmentWrite);
+    frameGraph.Use(scenePass, depthImage, ResourceAccess::DepthAttachmentWrite);
+    frameGraph.Use(scenePass, texture, ResourceAccess::FragmentShaderSample);
+
+    if (clusterCull) {
+        frameGraph.Use(scenePass, drawCommands, ResourceAccess::IndirectCommandRead);
+    }
+
+    if (upscale) {
+        uint32_t upscalePass = frameGraph.AddPass("upscale", [this, imageIndex](VkCommandBuffer cmd) { RecordUpscalePass(cmd, imageIndex); });
+        frameGraph.Use(upscalePass, sceneColor, ResourceAccess::TransferRead);
+        frameGraph.Use(upscalePass, swapchainImage, ResourceAccess::TransferWrite);
+    }
+
+    // the finished image is copied into a readback buffer the host reads after the fence
+    VkBuffer readbackBuffer = VK_NULL_HANDLE;
+
+    if (swapchainReadback && frameCapture->Wants(frameNumber)) {
+        readbackBuffer = frameReadback.Acquire(slot, swapChainImageExtent, swapChainImageFormat, frameNumber);
+    }
+
+    if (readbackBuffer != VK_NULL_HANDLE) {
+        auto readback = frameGraph.ImportBuffer(readbackBuffer, ResourceAccess::None);
+
+        uint32_t readbackPass = frameGraph.AddPass("readback", [this, slot, imageIndex](VkCommandBuffer cmd) { frameReadback.RecordCopy(cmd, slot, swapChainImageVec[imageIndex]); });
+        frameGraph.Use(readbackPass, swapchainImage, ResourceAccess::TransferRead);
+        frameGraph.Use(readbackPass, readback, ResourceAccess::TransferWrite);
+
+        frameGraph.Export(readback, ResourceAccess::HostRead);
+    }
+
+    frameGraph.Export(swapchainImage, ResourceAccess::Present);
+
+    frameGraph.Execute(cmdBuffer, &gpuProfiler);
+
+    gpuProfiler.EndFrame(cmdBuffer);
+
+    result = vkEndCommandBuffer(cmdBuffer);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not end command buffer!");
+    }
+}
+
+void Harmony::RecordCullPass(VkCommandBuffer cmdBuffer, uint32_t slot) {
+    // meshlet culling writes this slot's draw commands ahead of the rendering
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &cullDescSetVec[slot], 0, nullptr);
+    vkCmdPushConstants(cmdBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &cullConstantVec[slot]);
+
+    vkCmdDispatch(cmdBuffer, (cullConstantVec[slot].meshletCount + 63) / 64, 1, 1);
+}
+
+void Harmony::RecordScenePass(VkCommandBuffer cmdBuffer, uint32_t slot, VkImageView colorView) {
     VkClearValue clearValue[2];
 
     clearValue[0].color = {0.0, 0.0f, 0.0f, 1.0f};
@@ -1981,7 +3276,7 @@ void Harmony::RecordCommandBuffer(VkCommandBuffer cmdBuffer, uint32_t imageIndex
     VkRenderingAttachmentInfo colorAttachmentInfo {
         VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
         nullptr,
-        swapChainImageViewVec[imageIndex],
+        colorView,
         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
         VK_RESOLVE_MODE_NONE,
         VK_NULL_HANDLE,
@@ -1995,7 +3290,7 @@ void Harmony::RecordCommandBuffer(VkCommandBuffer cmdBuffer, uint32_t imageIndex
         VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
         nullptr,
         depthInfo.view,
-        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         VK_RESOLVE_MODE_NONE,
         VK_NULL_HANDLE,
         VK_IMAGE_LAYOUT_UNDEFINED,
@@ -2008,7 +3303,7 @@ void Harmony::RecordCommandBuffer(VkCommandBuffer cmdBuffer, uint32_t imageIndex
         VK_STRUCTURE_TYPE_RENDERING_INFO,
         nullptr,
         0,
-        VkRect2D{ VkOffset2D{}, VkExtent2D{swapChainImageExtent.width, swapChainImageExtent.height}},
+        VkRect2D{ VkOffset2D{}, renderExtent },
         1,
         0,
         1,
@@ -2020,12 +3315,100 @@ void Harmony::RecordCommandBuffer(VkCommandBuffer cmdBuffer, uint32_t imageIndex
     if (HasStencilComponent(depthFormat)) {
         renderInfo.pStencilAttachment = &depthAttachmentInfo;
     }
-    
+
+    if (reuseSceneCommands) {
+        VkCommandBuffer sceneCommands = SceneCommands(slot);
+
+        renderInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+
+        vkCmdBeginRendering(cmdBuffer, &renderInfo);
+        vkCmdExecuteCommands(cmdBuffer, 1, &sceneCommands);
+        vkCmdEndRendering(cmdBuffer);
+        return;
+    }
+
+    vkCmdBeginRendering(cmdBuffer, &renderInfo);
+    RecordSceneDraws(cmdBuffer, slot);
+    vkCmdEndRendering(cmdBuffer);
+}
+
+VkCommandBuffer Harmony::SceneCommands(uint32_t slot) {
+    SceneCommandBuffer& scene = sceneCommandVec[slot];
+
+    // the slot's fence has signalled, nothing executing it is pending
+    const bool current = !scene.dirty
+                      && scene.extent.width == renderExtent.width && scene.extent.height == renderExtent.height
+                      && scene.colorFormat == swapChainImageFormat
+                      && scene.depthFormat == depthFormat
+                      && scene.lod == lodVec[slot];
+
+    if (current) {
+        return scene.cmdBuffer;
+    }
+
+    CPU_ZONE("Record scene draws");
+
+    // the scene colour target has the swapchain's format
+    VkCommandBufferInheritanceRenderingInfo renderingInfo {
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+        nullptr,
+        0,                                                              // flags
+        0,                                                              // viewMask
+        1,
+        &swapChainImageFormat,
+        depthFormat,
+        HasStencilComponent(depthFormat) ? depthFormat : VK_FORMAT_UNDEFINED,
+        VK_SAMPLE_COUNT_1_BIT
+    };
+
+    VkCommandBufferInheritanceInfo inheritanceInfo {
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        &renderingInfo,
+        VK_NULL_HANDLE,                                                 // render pass, dynamic rendering
+        0,
+        VK_NULL_HANDLE,
+        VK_FALSE,                                                       // occlusionQueryEnable
+        0,
+        0                                                               // pipelineStatistics
+    };
+
+    VkCommandBufferBeginInfo beginInfo {
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        nullptr,
+        VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        &inheritanceInfo
+    };
+
+    // implicitly resets it, the pool allows that
+    VkResult result = vkBeginCommandBuffer(scene.cmdBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not begin scene command buffer!");
+    }
+
+    RecordSceneDraws(scene.cmdBuffer, slot);
+
+    result = vkEndCommandBuffer(scene.cmdBuffer);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not end scene command buffer!");
+    }
+
+    scene.extent      = renderExtent;
+    scene.colorFormat = swapChainImageFormat;
+    scene.depthFormat = depthFormat;
+    scene.lod         = lodVec[slot];
+    scene.dirty       = false;
+
+    sceneRecordCount++;
+
+    return scene.cmdBuffer;
+}
+
+void Harmony::RecordSceneDraws(VkCommandBuffer cmdBuffer, uint32_t slot) {
     VkViewport vp {
         0.0f,
         0.0f,
-        static_cast<float>(swapChainImageExtent.width),
-        static_cast<float>(swapChainImageExtent.height),
+        static_cast<float>(renderExtent.width),
+        static_cast<float>(renderExtent.height),
         0.0f,
         1.0f
     };
@@ -2033,43 +3416,210 @@ void Harmony::RecordCommandBuffer(VkCommandBuffer cmdBuffer, uint32_t imageIndex
     VkRect2D scissor{
         0,
         0,
-        swapChainImageExtent.width,
-        swapChainImageExtent.height,
+        renderExtent.width,
+        renderExtent.height,
     };
 
-    TransitionImage(cmdBuffer, swapChainImageVec[imageIndex],  swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-    TransitionImage(cmdBuffer, depthInfo.image, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    // every stream lives in the one vertex buffer
+    VkBuffer vbs[VertexInputDescription::MAX_STREAMS];
+    for (uint32_t s = 0; s < vertexInput.bindingCount; ++s) {
+        vbs[s] = vertexBufferInfo.buffer;
+    }
 
-    vkCmdBeginRendering(cmdBuffer, &renderInfo);
+    vkCmdBindVertexBuffers(cmdBuffer, 0, vertexInput.bindingCount, vbs, vertexStreamOffsets);
+
+    vkCmdBindIndexBuffer(cmdBuffer, indexBufferInfo.buffer, 0, mesh.IndexType());
+
+    vkCmdSetViewport(cmdBuffer, 0, 1, &vp);
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descSetVec[slot], 0, nullptr);
+
+    // both pipelines share the layout, so descriptors stay bound
+    if (depthPrepass) {
+        vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPrepassPipeline);
+
+        gpuProfiler.BeginStatistics(cmdBuffer, "depth prepass");
+        DrawMesh(cmdBuffer, slot);
+        gpuProfiler.EndStatistics(cmdBuffer);
+    }
 
+    // fragment invocations per pixel is the colour pass's overdraw
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
 
-    VkBuffer vbs[] = { vertexBufferInfo.buffer };
-    VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(cmdBuffer, 0, 1, vbs, offsets);
+    gpuProfiler.BeginStatistics(cmdBuffer, "colour", uint64_t(renderExtent.width) * renderExtent.height);
+    DrawMesh(cmdBuffer, slot);
+    gpuProfiler.EndStatistics(cmdBuffer);
+}
 
-    vkCmdBindIndexBuffer(cmdBuffer, indexBufferInfo.buffer, 0, VkIndexType::VK_INDEX_TYPE_UINT16);
+void Harmony::RecordUpscalePass(VkCommandBuffer cmdBuffer, uint32_t imageIndex) {
+    VkImageBlit blit {
+        { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },                                                             // srcSubresource
+        { VkOffset3D{ 0, 0, 0 }, VkOffset3D{ int32_t(renderExtent.width), int32_t(renderExtent.height), 1 } },  // srcOffsets
+        { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },                                                             // dstSubresource
+        { VkOffset3D{ 0, 0, 0 }, VkOffset3D{ int32_t(swapChainImageExtent.width), int32_t(swapChainImageExtent.height), 1 } }  // dstOffsets
+    };
 
-    vkCmdSetViewport(cmdBuffer, 0, 1, &vp);
-    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+    vkCmdBlitImage(cmdBuffer,
+        sceneColorInfo.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        swapChainImageVec[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1, &blit,
+        VK_FILTER_LINEAR);
+}
 
-    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descSetVec[imageIndex], 0, nullptr);
+void Harmony::DrawMesh(VkCommandBuffer cmdBuffer, uint32_t slot) {
+    const MeshLod& lod = lods[lodVec[slot]];
 
-    vkCmdPushConstants(cmdBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstant), &pushConstantVec[imageIndex]);
+    if (!clusterCull) {
+        vkCmdDrawIndexed(cmdBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
+        return;
+    }
 
-    vkCmdDrawIndexed(cmdBuffer, 12, 1, 0, 0, 0);
+    // one command per meshlet, culled ones have no instances; without multiDrawIndirect
+    // every command is its own indirect draw
+    const uint32_t stride       = sizeof(VkDrawIndexedIndirectCommand);
+    const uint32_t meshletCount = lod.meshletCount;
+    const uint32_t maxDraws     = choosenDeviceFeatures.features.multiDrawIndirect
+                                ? chosenDeviceProps.properties.limits.maxDrawIndirectCount
+                                : 1;
+
+    for (uint32_t first = 0; first < meshletCount; first += maxDraws) {
+        uint32_t count = std::min(maxDraws, meshletCount - first);
+        vkCmdDrawIndexedIndirect(cmdBuffer, drawCommandBufferVec[slot].buffer, VkDeviceSize(first) * stride, count, stride);
+    }
+}
 
-    vkCmdEndRendering(cmdBuffer);
+void Harmony::UpdateRenderScale() {
+    renderExtent = swapChainImageExtent;
 
-    TransitionImage(cmdBuffer, swapChainImageVec[imageIndex],  swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    if (!dynamicResolution) {
+        return;
+    }
 
-    result = vkEndCommandBuffer(cmdBuffer);
-    if (result != VK_SUCCESS) {
-        throw std::runtime_error("Could not end command buffer!");
+    // the GPU time this command buffer took last, at the scale it was recorded with
+    float&      frameScale = frameScaleVec[currentFrame];
+    const float gpuMs      = std::exchange(frameGpuMsVec[currentFrame], 0.0f);
+    const float oldScale   = resolutionScaler.Scale();
+
+    if (resolutionScaler.Update(gpuMs, frameScale) != oldScale) {
+        std::cout << "Render scale " << resolutionScaler.Scale() << ", GPU " << gpuMs << " ms" << std::endl;
+    }
+
+    renderExtent = {
+        ResolutionScaler::Scaled(swapChainImageExtent.width,  resolutionScaler.Scale()),
+        ResolutionScaler::Scaled(swapChainImageExtent.height, resolutionScaler.Scale())
+    };
+
+    frameScale = resolutionScaler.Scale();
+}
+
+void Harmony::CollectGpuFrame(uint32_t slot) {
+    if (!gpuProfiler.Collect(slot)) {
+        return;
+    }
+
+    // latency mode collects frames ahead of their slot coming round, the scaler reads them then
+    frameGpuMsVec[slot] = gpuProfiler.FrameMs(slot);
+
+    if (benchmark) {
+        benchmark->AddGpuFrame(benchmarkFrameVec[slot], gpuProfiler.FrameMs(slot));
+    }
+
+    // the slot's frame is the last one submitted with it
+    if (framePacer) {
+        framePacer->Completed(slotFrameVec[slot] - 1, gpuProfiler.FrameMs(slot), GpuTicksToHostMs(gpuProfiler.FrameEndTicks(slot)));
+    }
+
+    if (gpuProfile && ++gpuReportFrames == RollingStats::WINDOW) {
+        gpuProfiler.Report(std::cout);
+        gpuReportFrames = 0;
     }
 }
 
+void Harmony::StreamTextures() {
+    RetireUploads();
+
+    DecodedTexture texture;
+
+    while (textureLoader->Poll(texture)) {
+        if (!texture.error.empty()) {
+            std::cerr << texture.error << ", keeping the placeholder" << std::endl;
+            continue;
+        }
+
+        // the old texture lives on until no descriptor set or frame in flight uses it
+        replacedTextureVec.push_back(textureInfo);
+
+        if (CanHostCopy(texture)) {
+            // written and in its final layout on return, the next submit makes it visible
+            textureInfo = HostCopyTexture(texture);
+            textureDescDirtyVec.fill(true);
+
+            std::cout << "Texture: " << texture.path << " " << texture.width << "x" << texture.height << ", " << texture.mipLevels
+                      << " mips, format " << texture.format << ", decoded in " << texture.decodeMs << " ms, host copied" << std::endl;
+            continue;
+        }
+
+        PendingUpload upload;
+
+        upload.cmdBuffer = BeginOneTimeCommands();
+        textureInfo      = UploadTexture(upload.cmdBuffer, texture, upload.stagingBuffer);
+        upload.fence     = SubmitOneTimeCommands(upload.cmdBuffer);
+
+        pendingUploads.push_back(upload);
+
+        // the upload's barriers order it before every frame submitted after it on this queue,
+        // each descriptor set switches over once no frame in flight reads it
+        textureDescDirtyVec.fill(true);
+
+        std::cout << "Texture: " << texture.path << " " << texture.width << "x" << texture.height << ", " << texture.mipLevels
+                  << " mips, format " << texture.format << ", decoded in " << texture.decodeMs << " ms" << std::endl;
+    }
+}
+
+void Harmony::RetireUploads() {
+    for (auto it = pendingUploads.begin(); it != pendingUploads.end(); ) {
+        if (vkGetFenceStatus(device, it->fence) != VK_SUCCESS) {
+            ++it;
+            continue;
+        }
+
+        vkDestroyFence(device, it->fence, nullptr);
+        vkFreeCommandBuffers(device, commandPoolTx, 1, &it->cmdBuffer);
+        DestroyBuffer(it->stagingBuffer);
+
+        it = pendingUploads.erase(it);
+    }
+}
+
+void Harmony::UpdateTextureDescriptor(uint32_t slot) {
+    VkDescriptorImageInfo imageInfo {
+        sampler,
+        textureInfo.view,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+
+    VkWriteDescriptorSet writeDesc = ImageDescriptorWrite(descSetVec[slot], 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &imageInfo);
+
+    vkUpdateDescriptorSets(device, 1, &writeDesc, 0, nullptr);
+
+    // writing a bound set invalidates the command buffers it was recorded into
+    sceneCommandVec[slot].dirty = true;
+}
+
 void Harmony::Render() {
+    // the last frame's zones, Render's own included, now that they are all closed
+    if (!cpuTracePath.empty()) {
+        CpuProfiler::Collect();
+    }
+
+    CPU_FUNCTION_ZONE();
+
+    // the benchmark's CPU time is the frame's work up to submit, less the time blocked on the
+    // fence, the swapchain and the pacer
+    const double renderStartMs = HostMs();
+    double       blockedMs     = 0.0;
+
     VkResult result;
     uint32_t imageIndex;
 
@@ -2078,19 +3628,69 @@ void Harmony::Render() {
     auto& renderComplete = renderCompleteVec[currentFrame];
     auto& cmdBuffer      = cmdBufferVec[currentFrame];
 
-    vkWaitForFences(device, 1, &gpuBusy, VK_TRUE, UINT64_MAX);
+    {
+        CPU_ZONE("vkWaitForFences");
+        vkWaitForFences(device, 1, &gpuBusy, VK_TRUE, UINT64_MAX);
+    }
+
+    blockedMs += HostMs() - renderStartMs;
+
+    // the fence has signalled, so this command buffer's timestamps and readback are there to
+    // read, and what was retired while recording it can go
+    CollectGpuFrame(static_cast<uint32_t>(currentFrame));
+    frameReadback.Collect(static_cast<uint32_t>(currentFrame));
+    retireQueue.Collect(static_cast<uint32_t>(currentFrame), slotFrameVec[currentFrame]);
+
+    UpdateRenderScale();
+
+    StreamTextures();
     
-    result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageReady, VK_NULL_HANDLE, &imageIndex);
-    if( result == VK_ERROR_OUT_OF_DATE_KHR || windowResized == VK_TRUE) {
+    {
+        CPU_ZONE("vkAcquireNextImageKHR");
+
+        const double acquireStartMs = HostMs();
+        result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageReady, VK_NULL_HANDLE, &imageIndex);
+        blockedMs += HostMs() - acquireStartMs;
+    }
+
+    // nothing was acquired, so nothing will wait on imageReady; an image that was acquired
+    // is rendered and presented first, the resize follows the present
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
         OnWindowSizeChanged();
         return;
     }
 
+    // per frame state is the slot's, however many images the swapchain has: the last frame
+    // that bound this descriptor set is the one whose fence was waited for above
+    const uint32_t slot = static_cast<uint32_t>(currentFrame);
+
+    if (textureDescDirtyVec[slot]) {
+        UpdateTextureDescriptor(slot);
+        textureDescDirtyVec[slot] = false;
+    }
+
+    // with every set switched over, replaced textures only wait for the frames that sampled them
+    if (!replacedTextureVec.empty() && std::none_of(textureDescDirtyVec.begin(), textureDescDirtyVec.end(), [](bool dirty) { return dirty; })) {
+        for (ImageInfo& info : replacedTextureVec) {
+            RetireImage(info);
+        }
+
+        replacedTextureVec.clear();
+    }
+
+    // the frame starts here: as late as the GPU allows in latency mode, and everything it
+    // shows is sampled from here on
+    if (framePacer) {
+        blockedMs += PaceFrame();
+    }
+
+    const double frameStartMs = HostMs();
+
     // reset the fence only if we are submitting work to GPU
     vkResetFences(device, 1, &gpuBusy);
 
     vkResetCommandBuffer(cmdBuffer, 0);
-       UpdateUbo(imageIndex);
+       UpdateUbo(slot);
        RecordCommandBuffer(cmdBuffer, imageIndex);
 
     VkSemaphore          waitSemaphores[]   = { imageReady };
@@ -2110,11 +3710,21 @@ void Harmony::Render() {
         signalSemaphores
     };
 
-    result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, gpuBusy);
+    {
+        CPU_ZONE("vkQueueSubmit");
+        result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, gpuBusy);
+    }
+
     if (result != VK_SUCCESS) {
         throw std::runtime_error("Could not submit cmdbuffer!");
     }
 
+    const double submitMs = HostMs();
+
+    if (framePacer) {
+        framePacer->Submitted(frameNumber, frameStartMs, submitMs);
+    }
+
     VkPresentInfoKHR presentInfo {
         VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
         nullptr,
@@ -2126,30 +3736,42 @@ void Harmony::Render() {
         nullptr
     };
     
-    result = vkQueuePresentKHR(presentQueue, &presentInfo);
-    if( result == VK_ERROR_OUT_OF_DATE_KHR || windowResized == VK_TRUE) {
-        OnWindowSizeChanged();
-        return;
+    {
+        CPU_ZONE("vkQueuePresentKHR");
+        result = vkQueuePresentKHR(presentQueue, &presentInfo);
     }
 
+    // submitted, so the frame counts whether or not the swapchain has to be rebuilt
+    if (benchmark) {
+        benchmarkFrameVec[currentFrame] = benchmark->EndFrame(static_cast<float>(submitMs - renderStartMs - blockedMs));
+    }
+
+    // this slot's fence now completes every frame up to and including this one
+    slotFrameVec[currentFrame] = ++frameNumber;
+
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    // after moving on, so what the resize retires waits for the next frame's slot rather than
+    // stalling it on the fence of the frame just submitted
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || windowResized == VK_TRUE) {
+        OnWindowSizeChanged();
+    }
 }
 
 #pragma endregion
 /////////////////////////////////////////////////////////////////////////////////////////////
 #pragma region Misc
-uint32_t Harmony::SearchMemoryType(uint32_t typeBits, VkMemoryPropertyFlags mpFlags) {
-    VkPhysicalDeviceMemoryProperties memProps{};
-
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProps);
+bool Harmony::HasMemoryType(uint32_t typeBits, VkMemoryPropertyFlags mpFlags) {
+    return FindMemoryType(memoryProps, typeBits, mpFlags) >= 0;
+}
 
-    for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i) {
-        if ((typeBits & (1 << i)) && ((memProps.memoryTypes[i].propertyFlags & mpFlags) == mpFlags)) {
-            return i;
-        }
+uint32_t Harmony::SearchMemoryType(uint32_t typeBits, VkMemoryPropertyFlags mpFlags) {
+    int32_t index = FindMemoryType(memoryProps, typeBits, mpFlags);
+    if (index < 0) {
+        throw std::runtime_error("Could not find suitable memory type!");
     }
 
-    throw std::runtime_error("Could not find suitable memory type!");
+    return static_cast<uint32_t>(index);
 }
 
 Harmony::BufferInfo Harmony::CreateBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memPropFlags, VkDeviceSize size) {
@@ -2216,6 +3838,16 @@ void Harmony::DestroyBuffer(BufferInfo& buffInfo, bool defer) {
     }
 }
 
+void Harmony::RetireBuffer(BufferInfo& buffInfo) {
+    const uint32_t slot = static_cast<uint32_t>(currentFrame);
+
+    // freeing the memory unmaps it
+    retireQueue.RetireBuffer(slot, frameNumber, buffInfo.buffer);
+    retireQueue.RetireMemory(slot, frameNumber, buffInfo.memory);
+
+    buffInfo = {};
+}
+
 void Harmony::CopyBuffer(VkCommandBuffer cmdBuffer, VkBuffer src, VkBuffer dst, VkDeviceSize size) {
     VkBufferCopy bufferCopy {
         0,
@@ -2226,14 +3858,14 @@ void Harmony::CopyBuffer(VkCommandBuffer cmdBuffer, VkBuffer src, VkBuffer dst,
     vkCmdCopyBuffer(cmdBuffer, src, dst, 1, &bufferCopy);
 }
 
-void Harmony::CopyBufferToImage(VkCommandBuffer cmdBuffer, VkBuffer src, VkImage image, uint32_t width, uint32_t height) {
+void Harmony::CopyBufferToImage(VkCommandBuffer cmdBuffer, VkBuffer src, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevel, VkDeviceSize bufferOffset) {
     VkBufferImageCopy region {
-        0, // bufferOffset
+        bufferOffset, // bufferOffset
         0, // bufferRowLength
         0, // bufferImageHeight
         {  // imageSubresource
             VK_IMAGE_ASPECT_COLOR_BIT,
-            0,
+            mipLevel,
             0,
             1,
         },
@@ -2244,82 +3876,196 @@ void Harmony::CopyBufferToImage(VkCommandBuffer cmdBuffer, VkBuffer src, VkImage
     vkCmdCopyBufferToImage(cmdBuffer, src, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 }
 
-void Harmony::TransitionImage(VkCommandBuffer cmdBuffer, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageLayout oldLayout, VkImageLayout newLayout) {
-    VkPipelineStageFlags srcStageFlags = 0;
-    VkPipelineStageFlags dstStageFlags = 0;
+void Harmony::GenerateMipmaps(VkCommandBuffer cmdBuffer, VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels) {
+    int32_t w = static_cast<int32_t>(width);
+    int32_t h = static_cast<int32_t>(height);
+
+    // every level is blitted from the one above, which then is done and goes to shader read
+    for (uint32_t i = 1; i < mipLevels; ++i) {
+        CmdTransitionImage(cmdBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, ResourceAccess::TransferWrite, ResourceAccess::TransferRead, i - 1);
+
+        int32_t nw = std::max(w / 2, 1);
+        int32_t nh = std::max(h / 2, 1);
+
+        VkImageBlit blit {
+            { VK_IMAGE_ASPECT_COLOR_BIT, i - 1, 0, 1 },         // srcSubresource
+            { VkOffset3D{ 0, 0, 0 }, VkOffset3D{ w, h, 1 } },   // srcOffsets
+            { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 },             // dstSubresource
+            { VkOffset3D{ 0, 0, 0 }, VkOffset3D{ nw, nh, 1 } }  // dstOffsets
+        };
+
+        vkCmdBlitImage(cmdBuffer,
+            image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blit,
+            VK_FILTER_LINEAR);
+
+        CmdTransitionImage(cmdBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, ResourceAccess::TransferRead, ResourceAccess::FragmentShaderSample, i - 1);
+
+        w = nw;
+        h = nh;
+    }
+
+    CmdTransitionImage(cmdBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, ResourceAccess::TransferWrite, ResourceAccess::FragmentShaderSample, mipLevels - 1);
+}
+
+Harmony::ImageInfo Harmony::UploadTexture(VkCommandBuffer cmdBuffer, const DecodedTexture& texture, BufferInfo& stagingBuffer) {
+    VkResult result;
+
+    // levels packed back to back, offsets kept at the 16 byte block size
+    std::vector<VkDeviceSize> offsets(texture.levels.size());
+    VkDeviceSize              stagingSize = 0;
+
+    for (size_t i = 0; i < texture.levels.size(); ++i) {
+        offsets[i]   = stagingSize;
+        stagingSize += texture.levels[i].size;
+        stagingSize  = (stagingSize + 15) & ~VkDeviceSize(15);
+    }
+
+    stagingBuffer = CreateBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingSize);
+
+    void *stagingPtr = nullptr;
+    result = vkMapMemory(device, stagingBuffer.memory, 0, stagingSize, 0, &stagingPtr);
+    if (result == VK_SUCCESS) {
+        uint8_t* dst = static_cast<uint8_t*>(stagingPtr);
+
+        for (size_t i = 0; i < texture.levels.size(); ++i) {
+            memcpy_s(dst + offsets[i], stagingSize - offsets[i], texture.Data() + texture.levels[i].offset, texture.levels[i].size);
+        }
+
+        vkUnmapMemory(device, stagingBuffer.memory);
+    }
+    else {
+        throw std::runtime_error("Could not map staging memory!");
+    }
+
+    ImageInfo imageInfo = CreateImage(texture.format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, texture.width, texture.height, texture.mipLevels);
+
+    CmdTransitionImage(cmdBuffer, imageInfo.image, VK_IMAGE_ASPECT_COLOR_BIT, ResourceAccess::None, ResourceAccess::TransferWrite, 0, texture.mipLevels);
+
+    for (uint32_t i = 0; i < texture.levels.size(); ++i) {
+        CopyBufferToImage(cmdBuffer, stagingBuffer.buffer, imageInfo.image, texture.levels[i].width, texture.levels[i].height, i, offsets[i]);
+    }
+
+    // only level 0 came from the CPU, the rest is blitted on the GPU
+    if (texture.levels.size() < texture.mipLevels) {
+        GenerateMipmaps(cmdBuffer, imageInfo.image, texture.format, texture.width, texture.height, texture.mipLevels);
+    }
+    else {
+        CmdTransitionImage(cmdBuffer, imageInfo.image, VK_IMAGE_ASPECT_COLOR_BIT, ResourceAccess::TransferWrite, ResourceAccess::FragmentShaderSample, 0, texture.mipLevels);
+    }
+
+    return imageInfo;
+}
+
+bool Harmony::CanHostCopy(const DecodedTexture& texture) {
+    // every level has to come from the CPU, nothing here can blit
+    if (!hostImageCopy || texture.levels.size() != texture.mipLevels) {
+        return false;
+    }
+
+    VkFormatProperties3 formatProps3 {
+        VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3,
+    };
+
+    VkFormatProperties2 formatProps {
+        VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2,
+        &formatProps3,
+    };
 
-    auto flags = aspectFlags;
-    if (HasStencilComponent(format)) {
-        flags |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    vkGetPhysicalDeviceFormatProperties2(physicalDevice, texture.format, &formatProps);
+    if (!(formatProps3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT)) {
+        return false;
     }
 
+    // some devices lay out host copyable images in a way that samples slower; a texture
+    // is sampled every frame, so those keep the staging upload
+    VkHostImageCopyDevicePerformanceQueryEXT perfQuery {
+        VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT,
+    };
+
+    VkImageFormatProperties2 imageProps {
+        VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2,
+        &perfQuery,
+    };
+
+    VkPhysicalDeviceImageFormatInfo2 imageFormatInfo {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+        nullptr,
+        texture.format,
+        VK_IMAGE_TYPE_2D,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT,
+        0
+    };
+
+    VkResult result = vkGetPhysicalDeviceImageFormatProperties2(physicalDevice, &imageFormatInfo, &imageProps);
+
+    return result == VK_SUCCESS && perfQuery.optimalDeviceAccess;
+}
+
+Harmony::ImageInfo Harmony::HostCopyTexture(const DecodedTexture& texture) {
+    VkResult result;
+
+    ImageInfo imageInfo = CreateImage(texture.format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, texture.width, texture.height, texture.mipLevels);
+
     VkImageSubresourceRange range {
-        flags,
+        VK_IMAGE_ASPECT_COLOR_BIT,
         0, // mip
-        1, // count
+        texture.mipLevels, // count
         0, // array
         1  // count
     };
 
-    VkImageMemoryBarrier barrier {
-        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    VkHostImageLayoutTransitionInfoEXT transition {
+        VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
         nullptr,
-        0,
-        0,
-        oldLayout,
-        newLayout,
-        VK_QUEUE_FAMILY_IGNORED,
-        VK_QUEUE_FAMILY_IGNORED,
-        image,
-        range,
+        imageInfo.image,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        range
     };
 
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        srcStageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        dstStageFlags = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    result = vkTransitionImageLayout(device, 1, &transition);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not transition texture layout on the host!");
     }
-    else if(oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-        srcStageFlags = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        dstStageFlags = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    // straight from the decoded (or mapped) levels, rows tightly packed
+    std::vector<VkMemoryToImageCopyEXT> regions;
 
-        srcStageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        dstStageFlags = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    for (uint32_t i = 0; i < texture.levels.size(); ++i) {
+        regions.push_back(VkMemoryToImageCopyEXT {
+            VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+            nullptr,
+            texture.Data() + texture.levels[i].offset,
+            0, // row length
+            0, // image height
+            VkImageSubresourceLayers { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 },
+            VkOffset3D { 0, 0, 0 },
+            VkExtent3D { texture.levels[i].width, texture.levels[i].height, 1 }
+        });
     }
-    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
-        srcStageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        dstStageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    }
-    else if(oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
-        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        barrier.dstAccessMask = 0;
+    VkCopyMemoryToImageInfoEXT copyInfo {
+        VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+        nullptr,
+        0, // flags
+        imageInfo.image,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        static_cast<uint32_t>(regions.size()),
+        regions.data()
+    };
 
-        srcStageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dstStageFlags = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    result = vkCopyMemoryToImage(device, &copyInfo);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not copy texture from host memory!");
     }
 
-    vkCmdPipelineBarrier(cmdBuffer,
-        srcStageFlags,
-        dstStageFlags,
-        0,
-        0,  nullptr,
-        0,  nullptr,
-        1, &barrier);
+    return imageInfo;
 }
 
-Harmony::ImageInfo Harmony::CreateImage(VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags memPropFlags, VkImageAspectFlags aspectFlags, uint32_t width, uint32_t height) {
+Harmony::ImageInfo Harmony::CreateImage(VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags memPropFlags, VkImageAspectFlags aspectFlags, uint32_t width, uint32_t height, uint32_t mipLevels) {
     VkDeviceMemory memory;
     VkImage        image;
     VkResult       result;
@@ -2331,7 +4077,7 @@ Harmony::ImageInfo Harmony::CreateImage(VkFormat format, VkImageTiling tiling, V
         VK_IMAGE_TYPE_2D,
         format,
         VkExtent3D { width, height, 1 },
-        1,
+        mipLevels,
         1,
         VK_SAMPLE_COUNT_1_BIT,
         tiling,
@@ -2367,7 +4113,7 @@ Harmony::ImageInfo Harmony::CreateImage(VkFormat format, VkImageTiling tiling, V
         throw std::runtime_error("Could not bind image memory!");
     }
 
-    return {image, memory, CreateImageView(image, format, aspectFlags) };
+    return {image, memory, CreateImageView(image, format, aspectFlags, mipLevels) };
 }
 
 void Harmony::DestroyImage(ImageInfo& imgInfo, bool defer) {
@@ -2388,6 +4134,16 @@ void Harmony::DestroyImage(ImageInfo& imgInfo, bool defer) {
     }
 }
 
+void Harmony::RetireImage(ImageInfo& imgInfo) {
+    const uint32_t slot = static_cast<uint32_t>(currentFrame);
+
+    retireQueue.RetireImageView(slot, frameNumber, imgInfo.view);
+    retireQueue.RetireImage(slot, frameNumber, imgInfo.image);
+    retireQueue.RetireMemory(slot, frameNumber, imgInfo.memory);
+
+    imgInfo = {};
+}
+
 VkCommandBuffer Harmony::BeginOneTimeCommands() {
     VkResult result;
     VkCommandBuffer cmdBuffer;
@@ -2421,6 +4177,8 @@ VkCommandBuffer Harmony::BeginOneTimeCommands() {
 }
 
 void Harmony::EndOneTimeCommands(VkCommandBuffer cmdBuffer) {
+    CPU_FUNCTION_ZONE();
+
     VkResult result;
 
     result = vkEndCommandBuffer(cmdBuffer);
@@ -2449,7 +4207,48 @@ void Harmony::EndOneTimeCommands(VkCommandBuffer cmdBuffer) {
     vkFreeCommandBuffers(device, commandPoolTx, 1, &cmdBuffer);
 }
 
-VkImageView Harmony::CreateImageView(VkImage image, VkFormat imageFormat, VkImageAspectFlags aspectFlags) {
+VkFence Harmony::SubmitOneTimeCommands(VkCommandBuffer cmdBuffer) {
+    VkResult result;
+    VkFence  fence = VK_NULL_HANDLE;
+
+    result = vkEndCommandBuffer(cmdBuffer);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not end commandbuffer!");
+    }
+
+    VkFenceCreateInfo fnCreateInfo {
+        VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        nullptr,
+        0
+    };
+
+    result = vkCreateFence(device, &fnCreateInfo, nullptr, &fence);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not create fence!");
+    }
+
+    VkSubmitInfo submitInfo { 
+        VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        nullptr,
+        0,
+        nullptr,
+        nullptr,
+        1,
+        &cmdBuffer,
+        0,
+        nullptr
+    };
+
+    // no wait, the caller polls the fence
+    result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Could not submit transfer command buffer!");
+    }
+
+    return fence;
+}
+
+VkImageView Harmony::CreateImageView(VkImage image, VkFormat imageFormat, VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
     VkImageView imageView;
     VkResult result;
 
@@ -2461,7 +4260,7 @@ VkImageView Harmony::CreateImageView(VkImage image, VkFormat imageFormat, VkImag
         VK_IMAGE_VIEW_TYPE_2D,
         imageFormat,
         { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY },
-        { aspectFlags, 0, 1, 0, 1 }
+        { aspectFlags, 0, mipLevels, 0, 1 }
     };
 
     result = vkCreateImageView(device, &createInfo, nullptr, &imageView);
@@ -2490,28 +4289,186 @@ VkFormat Harmony::findSuitableFormat(const std::vector<VkFormat>& formats, const
 }
 
 void Harmony::OnWindowSizeChanged() {
-    vkDeviceWaitIdle(device);
+    CPU_FUNCTION_ZONE();
+
+    // frames keep flowing: the replacement is created from the old swapchain, and the old
+    // one, its views and the attachments are retired with the frame recorded next, so they
+    // go once every frame that rendered to them has finished. Fences do not cover the
+    // presentation engine; waiting for a frame after the last present to the old swapchain
+    // is as close as it gets without VK_EXT_swapchain_maintenance1's present fences
+    VkSurfaceCapabilitiesKHR surfaceCaps;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &surfaceCaps);
+
+    // minimized: no swapchain can be created, try again once the window is back
+    if (surfaceCaps.currentExtent.width == 0 || surfaceCaps.currentExtent.height == 0) {
+        return;
+    }
 
-    {
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            vkDestroyFramebuffer(device, swapChainFramebufferVec[i], nullptr);
+    const uint32_t slot         = static_cast<uint32_t>(currentFrame);
+    VkSwapchainKHR oldSwapchain = swapchain;
+
+    CreateSwapChain();
+
+    for (VkImageView view : swapChainImageViewVec) {
+        retireQueue.RetireImageView(slot, frameNumber, view);
+    }
+
+    retireQueue.RetireSwapchain(slot, frameNumber, oldSwapchain);
+
+    // rendering is dynamic, there are no framebuffers to rebuild
+    CreateImageViews();
+    CreateTransientAttachments();
+
+    windowResized = VK_FALSE;
+}
+
+void Harmony::StepResizeStorm() {
+    // decodes and uploads still to come would allocate whatever resizing does
+    const bool settled = textureLoader->Pending() == 0 && pendingUploads.empty();
+
+    uint32_t width  = 0;
+    uint32_t height = 0;
+
+    switch (resizeStorm->Step(settled, width, height)) {
+        case ResizeStorm::Action::Resize:
+            // WM_SIZE is handled before this returns, the next frame presents and recreates
+            SetWindowPos(hMainWindow, NULL, 0, 0, int(width), int(height), SWP_NOMOVE | SWP_NOZORDER | SWP_NOACTIVATE);
+            break;
+
+        case ResizeStorm::Action::Sample:
+            resizeStorm->Record(SampleMemory());
+            break;
+
+        case ResizeStorm::Action::None:
+            break;
+    }
+}
+
+// the time slept, 0 when the frame starts right away
+double Harmony::PaceFrame() {
+    // frames still in flight that have finished since tell where the GPU is; oldest first,
+    // and only behind a signalled fence so their queries are there
+    for (uint32_t i = 1; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        const uint32_t slot = static_cast<uint32_t>((currentFrame + i) % MAX_FRAMES_IN_FLIGHT);
+
+        if (vkGetFenceStatus(device, gpuBusyVec[slot]) == VK_SUCCESS) {
+            CollectGpuFrame(slot);
+        }
+    }
+
+    // the clocks drift apart slowly, a calibration a second keeps the mapping in the microseconds
+    const double now = HostMs();
+
+    if (now - gpuClockHostMs > 1000.0) {
+        CalibrateGpuClock();
+    }
+
+    if (!lowLatency) {
+        return 0.0;
+    }
+
+    const double wake = framePacer->WakeTime();
+
+    if (wake <= now) {
+        return 0.0;
+    }
+
+    CPU_ZONE("Pacing sleep");
+
+    SleepUntil(wake);
+
+    const double sleptMs = HostMs() - now;
+    framePacer->Slept(sleptMs);
+    return sleptMs;
+}
+
+void Harmony::CalibrateGpuClock() {
+    const VkCalibratedTimestampInfoEXT infos[2] = {
+        { VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, nullptr, VK_TIME_DOMAIN_DEVICE_EXT },
+        { VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, nullptr, VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT },
+    };
+
+    uint64_t timestamps[2];
+    uint64_t maxDeviation;
+
+    if (vkGetCalibratedTimestamps(device, 2, infos, timestamps, &maxDeviation) != VK_SUCCESS) {
+        return;
+    }
+
+    gpuClockTicks  = timestamps[0];
+    gpuClockHostMs = HostTicksToMs(timestamps[1]);
+}
+
+double Harmony::GpuTicksToHostMs(uint64_t ticks) const {
+    // timestamps wrap at the queue's valid bits; frames end shortly before or after a calibration
+    const uint64_t mask  = timestampBits >= 64 ? ~0ull : (1ull << timestampBits) - 1;
+    const uint64_t delta = (ticks - gpuClockTicks) & mask;
+
+    const double signedTicks = delta > mask / 2 ? -double(mask - delta + 1) : double(delta);
+
+    return gpuClockHostMs + signedTicks * chosenDeviceProps.properties.limits.timestampPeriod * 1e-6;
+}
+
+void Harmony::SleepUntil(double hostMs) {
+    // Sleep is only as fine as the scheduler tick; a high resolution waitable timer gets
+    // close, and the last stretch is spun
+    const double SPIN_MS = 0.5;
+
+    if (pacingTimer == NULL) {
+        pacingTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+        if (pacingTimer == NULL) {
+            pacingTimer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
         }
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            vkDestroyImageView(device, swapChainImageViewVec[i], nullptr);
+        if (pacingTimer != NULL) {
+            deletionQueue.Append([timer = pacingTimer] { CloseHandle(timer); });
         }
+    }
+
+    const double sleepMs = hostMs - HostMs() - SPIN_MS;
 
-        vkDestroyImageView(device, depthInfo.view, nullptr);
+    if (sleepMs > 0.0 && pacingTimer != NULL) {
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -static_cast<LONGLONG>(sleepMs * 10000.0);     // relative, 100 ns units
 
-        vkDestroySwapchainKHR(device, swapchain, nullptr);
+        if (SetWaitableTimer(pacingTimer, &dueTime, 0, NULL, NULL, FALSE)) {
+            WaitForSingleObject(pacingTimer, INFINITE);
+        }
     }
 
-    CreateSwapChain();
-    CreateImageViews();
-    CreateDepthImageAndView();
-    CreateFrameBuffers();
+    while (HostMs() < hostMs) {
+        YieldProcessor();
+    }
+}
 
-    windowResized = VK_FALSE;
+ResizeStorm::Sample Harmony::SampleMemory() {
+    ResizeStorm::Sample sample { 0, 0, retireQueue.PendingCount() };
+
+    PROCESS_MEMORY_COUNTERS_EX counters {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+        sample.hostBytes = counters.PrivateUsage;
+    }
+
+    // this process's allocations on every heap, as the driver counts them
+    if (memoryBudget) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget {
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+        };
+
+        VkPhysicalDeviceMemoryProperties2 props {
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            &budget,
+        };
+
+        vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &props);
+
+        for (uint32_t i = 0; i < props.memoryProperties.memoryHeapCount; ++i) {
+            sample.deviceBytes += budget.heapUsage[i];
+        }
+    }
+
+    return sample;
 }
 
 #pragma endregion
@@ -2528,18 +4485,127 @@ static void MakeConsole() {
     freopen_s(&fDummy, "CONOUT$", "w", stdout);
 }
 
+static LaunchOptions ParseCommandLine(int argc, char* argv[]) {
+    LaunchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+
+        if (arg == "--mesh" && i + 1 < argc) {
+            options.meshPath = argv[++i];
+        }
+        else if (arg == "--no-optimize") {
+            options.optimizeMesh = false;
+        }
+        else if (arg == "--no-depth-prepass") {
+            options.depthPrepass = false;
+        }
+        else if (arg == "--no-cluster-cull") {
+            options.clusterCull = false;
+        }
+        else if (arg == "--lods" && i + 1 < argc) {
+            options.lodCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--lod-threshold" && i + 1 < argc) {
+            options.lodThreshold = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--texture" && i + 1 < argc) {
+            options.texturePath = argv[++i];
+        }
+        else if (arg == "--cpu-mips") {
+            options.cpuMips = true;
+        }
+        else if (arg == "--pack" && i + 1 < argc) {
+            options.packPath = argv[++i];
+        }
+        else if (arg == "--no-pack") {
+            options.packPath.clear();
+        }
+        else if (arg == "--no-host-copy") {
+            options.hostImageCopy = false;
+        }
+        else if (arg == "--frame-budget" && i + 1 < argc) {
+            options.frameBudgetMs = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--min-scale" && i + 1 < argc) {
+            options.minRenderScale = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--gpu-profile") {
+            options.gpuProfile = true;
+        }
+        else if (arg == "--gpu-trace" && i + 1 < argc) {
+            options.gpuTracePath = argv[++i];
+        }
+        else if (arg == "--cpu-trace" && i + 1 < argc) {
+            options.cpuTracePath = argv[++i];
+        }
+        else if (arg == "--benchmark" && i + 1 < argc) {
+            options.benchmarkFrames = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmupFrames = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--timestep" && i + 1 < argc) {
+            options.timestepMs = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--benchmark-out" && i + 1 < argc) {
+            options.benchmarkPath = argv[++i];
+        }
+        else if (arg == "--capture" && i + 1 < argc) {
+            options.capturePath = argv[++i];
+        }
+        else if (arg == "--capture-every" && i + 1 < argc) {
+            options.captureEvery = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--low-latency") {
+            options.lowLatency = true;
+        }
+        else if (arg == "--report-latency") {
+            options.reportLatency = true;
+        }
+        else if (arg == "--resize-storm" && i + 1 < argc) {
+            options.resizeStorm = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--vertex-format" && i + 1 < argc) {
+            std::string fmt(argv[++i]);
+
+            if (fmt == "float") {
+                options.vertexFormat = VertexQuantizer::Mode::Float;
+            }
+            else if (fmt == "half") {
+                options.vertexFormat = VertexQuantizer::Mode::Half;
+            }
+            else if (fmt == "snorm16") {
+                options.vertexFormat = VertexQuantizer::Mode::Snorm16;
+            }
+            else {
+                options.vertexFormat = VertexQuantizer::Mode::Auto;
+            }
+        }
+        else {
+            std::cerr << "Ignoring unknown argument " << arg << std::endl;
+        }
+    }
+
+    return options;
+}
+
 int main(int argc, char* argv[]) {
     HINSTANCE instance = NULL;
     MakeConsole();
 
+    CPU_THREAD_NAME("main");
+
+    LaunchOptions options = ParseCommandLine(argc, argv);
+
     Harmony app;
 
-    if (!app.Init(instance)) {
+    if (!app.Init(instance, options)) {
         return -1;
     }
 
     app.Run();
     app.Shutdown(instance);
 
-    return 0;
+    return app.ExitCode();
 }
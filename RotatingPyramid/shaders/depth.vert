@@ -0,0 +1,15 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 viewProj;
+} objTransform;
+
+// position stream only
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = objTransform.viewProj * objTransform.model * vec4(inPosition, 1.0);
+}